@@ -0,0 +1,6 @@
+#!/bin/bash
+# Build the benchmark harness with optimizations and run it.
+# Usage: ./benchmark_script.sh [section...]
+mkdir -p build
+g++ -O3 -fno-trapping-math -pthread -o build/benchmark benchmarks/benchmark.cpp $(ls src/*.cpp | grep -v main.cpp)
+./build/benchmark "$@"
@@ -0,0 +1,583 @@
+//
+//  benchmark.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Benchmark harness for the library kernels.
+//  Build and run it with benchmark_script.sh. Each section can be run on its own:
+//      ./benchmark_script.sh sincos
+//  Without arguments every section runs.
+//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "../headers/activation_functions.h"
+#include "../headers/activation_funcs_gradient.h"
+#include "../headers/calibration.h"
+#include "../headers/expression.h"
+#include "../headers/graph.h"
+#include "../headers/huge_pages.h"
+#include "../headers/linalg.h"
+#include "../headers/network.h"
+#include "../headers/packed_gemm.h"
+#include "../headers/quantization.h"
+#include "../headers/static_network.h"
+#include "../headers/thread_pool.h"
+#include "../headers/vector_math.h"
+#include "../headers/weight_file.h"
+
+// Best time of several repetitions of fn, in nanoseconds
+static double time_ns(const std::function<void()>& fn, int repetitions = 10)
+{
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    return best;
+}
+
+// Per-call latency percentiles of fn over samples back-to-back calls, in nanoseconds
+struct Latency { double p50, p99; };
+
+static Latency latency_ns(const std::function<void()>& fn, int samples = 2000)
+{
+    std::vector<double> times(samples);
+    for (int warmup = 0; warmup < samples / 10; ++warmup) {
+        fn();
+    }
+    for (int s = 0; s < samples; ++s) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto stop = std::chrono::steady_clock::now();
+        times[s] = std::chrono::duration<double, std::nano>(stop - start).count();
+    }
+    std::sort(times.begin(), times.end());
+    return {times[samples / 2], times[(size_t)(samples * 0.99)]};
+}
+
+// Keeps the compiler from removing a computation whose result is unused
+static volatile float sink;
+
+// Sine activations on SIREN input ranges:
+//  first layer: omega_0 * (w.x + b) with omega_0 = 30 and inputs in [-1, 1], about U(-30, 30)
+//  hidden layers: pre-activations roughly N(0, 1) before omega_0, about N(0, 30) after
+static void bench_sincos()
+{
+    const size_t n = 1 << 20;
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> first_layer(-30.0f, 30.0f);
+    std::normal_distribution<float> hidden_layer(0.0f, 30.0f);
+
+    struct Range { const char* name; std::vector<float> x; };
+    std::vector<Range> ranges(2);
+    ranges[0].name = "first layer U(-30, 30)";
+    ranges[1].name = "hidden layer N(0, 30)";
+    for (size_t i = 0; i < n; ++i) {
+        ranges[0].x.push_back(first_layer(gen));
+        ranges[1].x.push_back(hidden_layer(gen));
+    }
+
+    std::printf("== sincos: %zu elements\n", n);
+    for (const Range& range : ranges) {
+        const std::vector<float>& x = range.x;
+        std::vector<float> y(n), dy(n);
+
+        double libm_sin = time_ns([&] { for (size_t i = 0; i < n; ++i) y[i] = std::sin(x[i]); });
+        double libm_sincos = time_ns([&] {
+            for (size_t i = 0; i < n; ++i) { y[i] = std::sin(x[i]); dy[i] = std::cos(x[i]); }
+        });
+        std::vector<float> buffer;
+        double fast_sin_ns = time_ns([&] { buffer = x; sinusoid_inplace(buffer); });
+        double fast_sincos_ns = time_ns([&] { sinusoid_with_gradient(x, y, dy); });
+
+        double max_error = 0.0;
+        sinusoid_with_gradient(x, y, dy);
+        for (size_t i = 0; i < n; ++i) {
+            max_error = std::max(max_error, std::fabs(y[i] - std::sin((double)x[i])));
+            max_error = std::max(max_error, std::fabs(dy[i] - std::cos((double)x[i])));
+        }
+        sink = y[n / 2] + dy[n / 2];
+
+        std::printf("%s\n", range.name);
+        std::printf("  sin     libm %7.2f ns/elem  fast %7.2f ns/elem  speedup %5.1fx\n",
+                    libm_sin / n, fast_sin_ns / n, libm_sin / fast_sin_ns);
+        std::printf("  sincos  libm %7.2f ns/elem  fast %7.2f ns/elem  speedup %5.1fx\n",
+                    libm_sincos / n, fast_sincos_ns / n, libm_sincos / fast_sincos_ns);
+        std::printf("  max abs error %.3g\n", max_error);
+    }
+}
+
+// Small calls as seen by an online serving path, under both wait policies of the thread pool:
+//  a batch-size-1 MLP forward, whose kernels are all below one chunk and run inline,
+//  a sigmoid over 3 chunks, below MIN_CHUNKS_TO_WAKE, which only uses workers already awake,
+//  a sigmoid over 16 chunks, which always goes to the pool.
+static void bench_latency()
+{
+    MLP mlp({256, 512, 512, 10}, Activation::ReLU);
+    std::vector<float> sample(256, 0.5f);
+    std::vector<float> small(3 * ELEMENTWISE_GRAIN, 0.5f), large(16 * ELEMENTWISE_GRAIN, 0.5f);
+
+    struct Workload { const char* name; std::function<void()> run; };
+    std::vector<Workload> workloads = {
+        {"mlp 256-512-512-10 batch 1", [&] { sink = mlp.forward(sample, 1)[0]; }},
+        {"sigmoid 3 chunks", [&] { sigmoid_inplace(small); sink = small[0]; }},
+        {"sigmoid 16 chunks", [&] { sigmoid_inplace(large); sink = large[0]; }},
+    };
+
+    struct Policy { const char* name; WaitPolicy policy; };
+    const Policy policies[] = {{"passive", WaitPolicy::Passive}, {"latency", WaitPolicy::Latency}};
+
+    std::printf("== latency: %d threads, back-to-back calls\n", num_threads());
+    for (const Workload& workload : workloads) {
+        std::printf("%s\n", workload.name);
+        for (const Policy& policy : policies) {
+            ThreadPoolConfig config;
+            config.wait_policy = policy.policy;
+            configure_thread_pool(config);
+            Latency latency = latency_ns(workload.run);
+            std::printf("  %-8s p50 %9.2f us  p99 %9.2f us\n", policy.name, latency.p50 / 1e3, latency.p99 / 1e3);
+        }
+    }
+    configure_thread_pool(ThreadPoolConfig());
+}
+
+// Counts the data TLB load misses of this thread between start() and stop() with perf_event_open.
+// available() is false when the kernel or the VM does not expose the counter.
+class DtlbMissCounter {
+public:
+    DtlbMissCounter()
+    {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+    ~DtlbMissCounter()
+    {
+#if defined(__linux__)
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+    bool available() const { return fd_ >= 0; }
+    void start()
+    {
+#if defined(__linux__)
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    long long stop()
+    {
+        long long count = 0;
+#if defined(__linux__)
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+// Bytes of the mapping starting at data that are backed by transparent huge pages (/proc/self/smaps)
+static size_t anon_huge_bytes(const void* data)
+{
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool in_mapping = false;
+    while (std::getline(smaps, line)) {
+        unsigned long long begin, end;
+        if (std::sscanf(line.c_str(), "%llx-%llx ", &begin, &end) == 2 && line.find(':') > line.find(' ')) {
+            in_mapping = begin <= (unsigned long long)(uintptr_t)data && (unsigned long long)(uintptr_t)data < end;
+        } else if (in_mapping && line.compare(0, 14, "AnonHugePages:") == 0) {
+            std::istringstream fields(line.substr(14));
+            size_t kb = 0;
+            fields >> kb;
+            return kb * 1024;
+        }
+    }
+    return 0;
+}
+
+// Random row gathers, the access pattern of an embedding lookup or a scattered KV cache read,
+// over a 512 MB buffer on 4 KB pages and on huge pages.
+static void bench_hugepages()
+{
+    const size_t floats = size_t(128) << 20;
+    const size_t row = 16;
+    const size_t rows = floats / row;
+    const size_t lookups = 1 << 22;
+
+    std::mt19937_64 gen(1);
+    std::vector<size_t> ids(lookups);
+    for (size_t& id : ids) id = gen() % rows;
+
+    auto gather = [&](const float* data) {
+        float sum = 0.0f;
+        for (size_t id : ids) {
+            const float* r = data + id * row;
+            for (size_t j = 0; j < row; ++j) sum += r[j];
+        }
+        sink = sum;
+    };
+
+    DtlbMissCounter counter;
+    std::printf("== hugepages: %zu random %zu-float rows out of %zu MB\n", lookups, row, floats * sizeof(float) >> 20);
+
+    double regular_ns, huge_ns;
+    long long regular_misses, huge_misses;
+    {
+        std::vector<float> buffer(floats, 1.0f);
+        gather(buffer.data());
+        counter.start();
+        regular_ns = time_ns([&] { gather(buffer.data()); }, 3);
+        regular_misses = counter.stop();
+    }
+    size_t huge_bytes;
+    PageKind kind;
+    {
+        float* buffer = static_cast<float*>(huge_page_alloc(floats * sizeof(float), &kind));
+        std::fill(buffer, buffer + floats, 1.0f);
+        huge_bytes = anon_huge_bytes(buffer);
+        gather(buffer);
+        counter.start();
+        huge_ns = time_ns([&] { gather(buffer); }, 3);
+        huge_misses = counter.stop();
+        huge_page_free(buffer, floats * sizeof(float));
+    }
+
+    const char* kinds[] = {"regular pages", "transparent huge pages", "hugetlbfs"};
+    std::printf("huge buffer: %s, %zu MB on huge pages\n", kinds[(int)kind], huge_bytes >> 20);
+    std::printf("  4 KB pages  %7.2f ns/row\n", regular_ns / lookups);
+    std::printf("  huge pages  %7.2f ns/row  speedup %5.2fx\n", huge_ns / lookups, regular_ns / huge_ns);
+    if (counter.available()) {
+        std::printf("  dTLB load misses per row  %.3f -> %.3f\n", regular_misses / (3.0 * lookups), huge_misses / (3.0 * lookups));
+    } else {
+        std::printf("  dTLB load misses: no hardware counter (perf_event_open failed)\n");
+    }
+}
+
+// A memory-bound elementwise block over 16 MB tensors, scale/shift -> relu -> residual add ->
+// hardtanh -> scale/shift -> hardsigmoid -> mean squared error, run as built and after fuse()
+static void bench_fusion()
+{
+    const int batch = 16384, width = 256;
+    auto build = [&](InferenceGraph& graph) {
+        int h = graph.scale_shift(graph.input(), 0.5f, 0.1f);
+        h = graph.activation(h, Activation::ReLU);
+        h = graph.add(h, graph.input());
+        h = graph.activation(h, Activation::Hardtanh);
+        h = graph.scale_shift(h, 4.0f, 0.0f);
+        int p = graph.activation(h, Activation::Hardsigmoid);
+        graph.loss(p, graph.targets(width), GraphLoss::MeanSquaredError);
+    };
+    InferenceGraph plain(width), fused(width);
+    build(plain);
+    build(fused);
+    FusionReport report = fused.fuse();
+    plain.compile(batch);
+    fused.compile(batch);
+
+    std::vector<float> input((size_t)batch * width), targets((size_t)batch * width);
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) x = dist(gen);
+    for (float& t : targets) t = dist(gen) > 0.0f ? 1.0f : 0.0f;
+
+    double plain_ns = time_ns([&] { sink = plain.run(input.data(), targets.data(), batch)[0]; });
+    double fused_ns = time_ns([&] { sink = fused.run(input.data(), targets.data(), batch)[0]; });
+
+    std::printf("== fusion: batch %d, width %d\n", batch, width);
+    std::printf("nodes %d -> %d, memory passes saved %d\n", report.nodes_before, report.nodes_after, report.memory_passes_saved);
+    std::printf("  arena   %6zu KB -> %6zu KB\n", plain.arena_bytes() >> 10, fused.arena_bytes() >> 10);
+    std::printf("  run     %8.1f us -> %8.1f us  speedup %5.2fx\n", plain_ns / 1e3, fused_ns / 1e3, plain_ns / fused_ns);
+
+    // Residual block a + relu(a): fusion makes a both the streamed and a side input of one node
+    auto residual = [](InferenceGraph& graph) {
+        int a = graph.scale_shift(graph.input(), 1.0f, 0.0f);
+        graph.add(graph.activation(a, Activation::ReLU), a);
+    };
+    InferenceGraph residual_plain(width), residual_fused(width);
+    residual(residual_plain);
+    residual(residual_fused);
+    residual_fused.fuse();
+    residual_plain.compile(batch);
+    residual_fused.compile(batch);
+    const float* expected = residual_plain.run(input.data(), batch);
+    const float* actual = residual_fused.run(input.data(), batch);
+    float max_error = 0.0f;
+    for (size_t i = 0; i < input.size(); ++i) {
+        max_error = std::max(max_error, std::fabs(expected[i] - actual[i]));
+    }
+    std::printf("  residual a + relu(a), fused vs unfused max error %g\n", max_error);
+}
+
+// out = sigmoid(a) * b + c: eager vector functions versus one lazy expression loop
+static void bench_expression()
+{
+    const size_t n = size_t(1) << 22;
+    std::vector<float> a(n), b(n), c(n), out(n);
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = dist(gen);
+        b[i] = dist(gen);
+        c[i] = dist(gen);
+    }
+
+    // Same fast_sigmoid and temporaries allocated once, so only the number of passes differs
+    std::vector<float> s(n), p(n);
+    double eager_ns = time_ns([&] {
+        for (size_t i = 0; i < n; ++i) s[i] = fast_sigmoid(a[i]);
+        for (size_t i = 0; i < n; ++i) p[i] = s[i] * b[i];
+        for (size_t i = 0; i < n; ++i) out[i] = p[i] + c[i];
+        sink = out[0];
+    });
+    double lazy_ns = time_ns([&] {
+        lazy(out) = sigmoid(lazy(a)) * b + c;
+        sink = out[0];
+    });
+
+    std::printf("== expression: sigmoid(a) * b + c over %zu floats\n", n);
+    std::printf("  eager   %8.1f us  (2 preallocated temporaries, 3 loops)\n", eager_ns / 1e3);
+    std::printf("  lazy    %8.1f us  speedup %5.2fx\n", lazy_ns / 1e3, eager_ns / lazy_ns);
+}
+
+// 16 -> 32 -> 1 scoring MLP at batch 1, the dynamic MLP versus the same weights in a StaticMLP
+static void bench_static()
+{
+    const int calls = 10000;
+    MLP mlp({16, 32, 1}, Activation::ReLU, Activation::Sigmoid);
+    StaticMLP<StaticDense<16, 32, Activation::ReLU>, StaticDense<32, 1, Activation::Sigmoid>> scorer(mlp.layers());
+    std::vector<float> sample(16, 0.5f);
+    decltype(scorer)::Input input;
+    std::copy(sample.begin(), sample.end(), input.begin());
+
+    double dynamic_ns = time_ns([&] {
+        for (int c = 0; c < calls; ++c) {
+            sample[c & 15] += 1e-6f;
+            sink = mlp.forward(sample, 1)[0];
+        }
+    }) / calls;
+    double static_ns = time_ns([&] {
+        for (int c = 0; c < calls; ++c) {
+            input[c & 15] += 1e-6f;
+            sink = scorer.forward(input)[0];
+        }
+    }) / calls;
+
+    std::printf("== static: mlp 16-32-1 batch 1, per call\n");
+    std::printf("  MLP       %8.1f ns\n", dynamic_ns);
+    std::printf("  StaticMLP %8.1f ns  speedup %5.2fx\n", static_ns, dynamic_ns / static_ns);
+}
+
+// Startup with a 256 MB weight file: reading it into a vector versus mapping it
+static void bench_weights()
+{
+    const std::string path = "/tmp/dllib_benchmark.dlw";
+    std::vector<float> weights((size_t(256) << 20) / sizeof(float), 0.5f);
+    WeightFileWriter writer;
+    writer.add("weights", weights.data(), {weights.size()});
+    writer.write(path);
+
+    // What a loader that deserializes does at least: copy every byte into process memory
+    double read_ns = time_ns([&] {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        std::vector<char> bytes((size_t)file.tellg());
+        file.seekg(0);
+        file.read(bytes.data(), bytes.size());
+        sink = bytes.back();
+    }, 3);
+    double map_ns = time_ns([&] {
+        WeightFile file(path);
+        sink = file.floats("weights", {weights.size()})[0];
+    }, 3);
+    std::remove(path.c_str());
+
+    std::printf("== weights: open a 256 MB weight file (page cache warm)\n");
+    std::printf("  read    %10.1f us\n", read_ns / 1e3);
+    std::printf("  mmap    %10.1f us  speedup %7.0fx\n", map_ns / 1e3, read_ns / map_ns);
+}
+
+// 1024 x 1024 weights: gemm against gemm_packed, and a start with and without the packed cache
+static void bench_packed()
+{
+    const int k = 1024, n = 1024;
+    const std::string path = "/tmp/dllib_benchmark_packed.dlw";
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> weights((size_t)k * n);
+    for (float& w : weights) w = dist(gen);
+    WeightFileWriter writer;
+    writer.add("weights", weights.data(), {(size_t)k, (size_t)n});
+    writer.write(path);
+    WeightFile model(path);
+
+    std::printf("== packed: %s, %d x %d weights\n", native_gemm_layout().key().c_str(), k, n);
+    PackedMatrix packed(weights.data(), k, n, n);
+    for (int m : {1, 16, 64}) {
+        std::vector<float> a((size_t)m * k), c((size_t)m * n);
+        for (float& x : a) x = dist(gen);
+        double gemm_ns = time_ns([&] {
+            gemm(false, false, m, n, k, 1.0f, a.data(), k, weights.data(), n, 0.0f, c.data(), n);
+            sink = c[0];
+        });
+        double packed_ns = time_ns([&] {
+            gemm_packed(m, a.data(), k, packed, 0.0f, c.data(), n);
+            sink = c[0];
+        });
+        std::printf("  batch %2d  gemm %8.1f us  packed %8.1f us  speedup %5.2fx\n",
+                    m, gemm_ns / 1e3, packed_ns / 1e3, gemm_ns / packed_ns);
+    }
+
+    std::string cache_path;
+    double cold_ns = time_ns([&] {
+        PackedWeightCache cache(model, path);
+        cache_path = cache.path();
+        std::remove(cache_path.c_str());
+    }, 3);
+    { PackedWeightCache cache(model, path); }
+    double warm_ns = time_ns([&] { PackedWeightCache cache(model, path); }, 3);
+    std::remove(cache_path.c_str());
+    std::remove(path.c_str());
+    std::printf("  start without cache %8.1f us, with cache %8.1f us\n", cold_ns / 1e3, warm_ns / 1e3);
+}
+
+static void bench_int8()
+{
+    const int k = 1024, n = 1024;
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    Dense layer(k, n, Activation::ReLU);
+    PackedMatrix packed(layer.weights.data(), k, n, n);
+    QuantParams input_params{1.0f / 127.0f, 0}, output_params{0.25f, -128};
+    QuantizedDense quantized(layer, input_params, output_params);
+
+    std::printf("== int8: %s, %d x %d weights, ReLU\n", int8_kernel(), k, n);
+    for (int m : {1, 16, 64}) {
+        std::vector<float> a((size_t)m * k), c((size_t)m * n);
+        for (float& x : a) x = dist(gen);
+        std::vector<int8_t> a_q = quantize(a, input_params), c_q((size_t)m * n);
+        double float_ns = time_ns([&] {
+            gemm_packed(m, a.data(), k, packed, 0.0f, c.data(), n);
+            activation_forward_inplace(Activation::ReLU, c);
+            sink = c[0];
+        });
+        double int8_ns = time_ns([&] {
+            quantized.forward(a_q.data(), c_q.data(), m);
+            sink = c_q[0];
+        });
+        std::printf("  batch %2d  float packed %8.1f us  int8 %8.1f us  speedup %5.2fx\n",
+                    m, float_ns / 1e3, int8_ns / 1e3, float_ns / int8_ns);
+    }
+}
+
+// Relative RMS error of the int8 MLP against the float one, for each calibration method, on
+// N(0, 1) inputs. The second calibration set has 1 value in 2000 scaled by 40: min-max widens
+// every scale to cover them, the clipping methods do not.
+static void bench_calibration()
+{
+    const int batch = 64, batches = 10;
+    MLP mlp({64, 128, 128, 10}, Activation::ReLU);
+    const std::vector<Dense>& layers = mlp.layers();
+    std::mt19937 gen(3);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    auto make_batch = [&](bool outliers) {
+        std::vector<float> x((size_t)batch * 64);
+        for (float& v : x) {
+            v = dist(gen);
+            if (outliers && gen() % 2000 == 0) v *= 40.0f;
+        }
+        return x;
+    };
+    std::vector<float> test = make_batch(false);
+    std::vector<float> reference = mlp.forward(test, batch);
+
+    const char* names[] = {"min-max", "percentile", "entropy"};
+    const CalibrationMethod methods[] = {CalibrationMethod::MinMax, CalibrationMethod::Percentile, CalibrationMethod::Entropy};
+    std::printf("== calibration: MLP 64-128-128-10 ReLU, %d calibration rows, relative RMS error of the int8 output\n",
+                batch * batches);
+    for (bool outliers : {false, true}) {
+        Calibrator calibrator(layers);
+        for (int b = 0; b < batches; ++b) {
+            calibrator.observe(make_batch(outliers), batch);
+        }
+        std::printf("  calibration set %-13s", outliers ? "with outliers" : "N(0, 1)");
+        for (int m = 0; m < 3; ++m) {
+            std::vector<QuantParams> params = calibrator.params(methods[m]);
+            std::vector<QuantizedDense> quantized = quantize_layers(layers, params);
+            std::vector<int8_t> x = quantize(test, params[0]), y;
+            for (const QuantizedDense& layer : quantized) {
+                layer.forward(x, y, batch);
+                x.swap(y);
+            }
+            std::vector<float> output = dequantize(x, params.back());
+            double error = 0.0, norm = 0.0;
+            for (size_t i = 0; i < output.size(); ++i) {
+                error += (output[i] - reference[i]) * (output[i] - reference[i]);
+                norm += reference[i] * reference[i];
+            }
+            std::printf("  %s %5.1f%%", names[m], 100.0 * std::sqrt(error / norm));
+        }
+        std::printf("\n");
+    }
+}
+
+struct Section {
+    const char* name;
+    void (*run)();
+};
+
+static const Section sections[] = {
+    {"sincos", bench_sincos},
+    {"latency", bench_latency},
+    {"hugepages", bench_hugepages},
+    {"fusion", bench_fusion},
+    {"expression", bench_expression},
+    {"static", bench_static},
+    {"weights", bench_weights},
+    {"packed", bench_packed},
+    {"int8", bench_int8},
+    {"calibration", bench_calibration},
+};
+
+int main(int argc, const char* argv[])
+{
+    for (const Section& section : sections) {
+        bool selected = argc < 2;
+        for (int a = 1; a < argc; ++a) {
+            selected |= std::strcmp(argv[a], section.name) == 0;
+        }
+        if (selected) {
+            section.run();
+        }
+    }
+    return 0;
+}
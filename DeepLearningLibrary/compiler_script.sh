@@ -2,9 +2,9 @@
 # g++ -c headers/activation_functions.cpp
 # g++ -c headers/preprocessing.cpp
 # g++ -c main.cpp
-g++ -c src/*.cpp
+g++ -c -O3 -fno-trapping-math -pthread src/*.cpp
 # g++ -c main.cpp
-g++ -o main *.o
+g++ -pthread -o main *.o
 # g++ -o main *.o
 
 # mkdir build
@@ -1,4 +1,7 @@
 #pragma once
+
+#include <vector>
+
 // Activation functions gradients
 // These functions compute the gradients of various activation functions.   
 // The gradients are essential for backpropagation in neural networks, allowing the model to learn from the errors during training.
@@ -17,4 +20,42 @@ float swish_gradient(float x);
 float mish_gradient(float x);
 float gelu_gradient(float x);
 float gaussian_gradient(float x);
-float sinusoid_gradient(float x);
\ No newline at end of file
+float sinusoid_gradient(float x);
+float relu6_gradient(float x);
+float hardtanh_gradient(float x, float min_val = -1.0f, float max_val = 1.0f);
+float hardsigmoid_gradient(float x);
+float hardswish_gradient(float x);
+
+// Gradients computed from the activation output y = f(x) instead of the input x.
+// They avoid recomputing the forward pass and let the input buffer be overwritten in place.
+float relu_gradient_from_output(float y);
+float sigmoid_gradient_from_output(float y);
+float tanh_gradient_from_output(float y);
+float elu_gradient_from_output(float y, float alpha = 1.0f);
+float softplus_gradient_from_output(float y);
+
+// Backward passes over a buffer: grad is the upstream gradient dL/dy and is overwritten with dL/dx.
+// output is the buffer produced by the matching *_inplace activation.
+void relu_backward_inplace(const std::vector<float>& output, std::vector<float>& grad);
+void sigmoid_backward_inplace(const std::vector<float>& output, std::vector<float>& grad);
+void tanh_backward_inplace(const std::vector<float>& output, std::vector<float>& grad);
+void elu_backward_inplace(const std::vector<float>& output, std::vector<float>& grad, float alpha = 1.0f);
+void softplus_backward_inplace(const std::vector<float>& output, std::vector<float>& grad);
+void relu6_backward_inplace(const std::vector<float>& output, std::vector<float>& grad);
+void hardtanh_backward_inplace(const std::vector<float>& output, std::vector<float>& grad,
+                               float min_val = -1.0f, float max_val = 1.0f);
+void hardsigmoid_backward_inplace(const std::vector<float>& output, std::vector<float>& grad);
+// Hardswish is not monotonic, its gradient needs the input, not the output
+void hardswish_backward_inplace(const std::vector<float>& input, std::vector<float>& grad);
+// Sinusoid: the gradient cos(x) needs the input. sinusoid_with_gradient() in activation_functions.h
+// gives sin and cos in one pass when the input is not kept.
+void sinusoid_backward_inplace(const std::vector<float>& input, std::vector<float>& grad);
+
+// Backward passes of the gated activations: from the projection output [a | b] (rows x 2n) and
+// dL/d(output) (rows x n), grad_input receives [dL/da | dL/db] (rows x 2n) in one pass.
+void glu_backward(const std::vector<float>& input, const std::vector<float>& grad_output,
+                  std::vector<float>& grad_input, int rows);
+void swiglu_backward(const std::vector<float>& input, const std::vector<float>& grad_output,
+                     std::vector<float>& grad_input, int rows);
+void geglu_backward(const std::vector<float>& input, const std::vector<float>& grad_output,
+                    std::vector<float>& grad_input, int rows);
@@ -7,6 +7,11 @@
 
 #pragma once
 
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "quantization.h"
+
 // Activation functions
 int identity(int x);
 int binary_step(int x);
@@ -23,4 +28,60 @@ float sigmoid(float x);
 float dllib_tanh(float x);
 float softplus(float x, float alpha = 1.0f);
 float softsign(float x);
+// Hard (piecewise linear) activations, no transcendental functions
+float relu6(float x);
+float hardtanh(float x, float min_val = -1.0f, float max_val = 1.0f);
+float hardsigmoid(float x);
+float hardswish(float x);
+
+// In-place activations over a buffer, the output overwrites the input.
+// Pair them with the *_backward_inplace functions in activation_funcs_gradient.h,
+// which only need the output to compute the gradient.
+// The pointer forms work on n floats at x, e.g. a slice of a larger arena.
+void relu_inplace(float* x, size_t n);
+void sigmoid_inplace(float* x, size_t n);
+void tanh_inplace(float* x, size_t n);
+void elu_inplace(float* x, size_t n, float alpha = 1.0f);
+void softplus_inplace(float* x, size_t n);
+void relu6_inplace(float* x, size_t n);
+void hardtanh_inplace(float* x, size_t n, float min_val = -1.0f, float max_val = 1.0f);
+void hardsigmoid_inplace(float* x, size_t n);
+void hardswish_inplace(float* x, size_t n);
+void sinusoid_inplace(float* x, size_t n);
+void relu_inplace(std::vector<float>& x);
+void sigmoid_inplace(std::vector<float>& x);
+void tanh_inplace(std::vector<float>& x);
+void elu_inplace(std::vector<float>& x, float alpha = 1.0f);
+void softplus_inplace(std::vector<float>& x);
+void relu6_inplace(std::vector<float>& x);
+void hardtanh_inplace(std::vector<float>& x, float min_val = -1.0f, float max_val = 1.0f);
+void hardsigmoid_inplace(std::vector<float>& x);
+void hardswish_inplace(std::vector<float>& x);
+void sinusoid_inplace(std::vector<float>& x);
+// The sinusoid forms use fast_sincos (vector_math.h), accurate to a few ulp for |x| < 6000. A chunk
+// holding larger values is computed with std::sin and std::cos instead, correct but not vectorized.
+// SIREN training step: output = sin(x) and derivative = cos(x) from a single range reduction.
+// The backward pass is then grad *= derivative, without keeping x.
+void sinusoid_with_gradient(const std::vector<float>& x, std::vector<float>& output, std::vector<float>& derivative);
+
+// Int8 versions of the hard activations on quantized buffers.
+// The output may use different quantization parameters than the input.
+void relu6_int8(const std::vector<int8_t>& input, const QuantParams& input_params,
+                std::vector<int8_t>& output, const QuantParams& output_params);
+void hardtanh_int8(const std::vector<int8_t>& input, const QuantParams& input_params,
+                   std::vector<int8_t>& output, const QuantParams& output_params,
+                   float min_val = -1.0f, float max_val = 1.0f);
+void hardsigmoid_int8(const std::vector<int8_t>& input, const QuantParams& input_params,
+                      std::vector<int8_t>& output, const QuantParams& output_params);
+void hardswish_int8(const std::vector<int8_t>& input, const QuantParams& input_params,
+                    std::vector<int8_t>& output, const QuantParams& output_params);
+
+// Gated activations over the output of a projection to 2 * n features.
+// Each input row is [a | b] (rows x 2n), the output is act(a) * b (rows x n), in one pass:
+//  GLU:    sigmoid(a) * b
+//  SwiGLU: swish(a) * b
+//  GeGLU:  gelu(a) * b
+void glu(const std::vector<float>& input, std::vector<float>& output, int rows);
+void swiglu(const std::vector<float>& input, std::vector<float>& output, int rows);
+void geglu(const std::vector<float>& input, std::vector<float>& output, int rows);
 // Add more activation functions as needed
\ No newline at end of file
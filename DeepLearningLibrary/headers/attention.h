@@ -0,0 +1,44 @@
+//
+//  attention.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+
+// Shape of a multi-head scaled dot-product attention.
+// q is batch x heads x q_len x head_dim, k and v are batch x heads x kv_len x head_dim,
+// so the rows of one head are contiguous.
+// With causal masking, query i attends to the keys j <= i + (kv_len - q_len), i.e. the queries
+// are the last q_len positions of the key sequence.
+struct AttentionConfig {
+    int batch = 1;
+    int heads = 1;
+    int q_len = 0;
+    int kv_len = 0;
+    int head_dim = 0;
+    bool causal = false;
+    float scale = 0.0f;   // 0 means 1 / sqrt(head_dim)
+};
+
+// out = softmax(q * k^T * scale) * v, computed tile by tile with an online softmax, without
+// ever building the q_len x kv_len score matrix.
+// logsumexp (batch x heads x q_len) receives the softmax normalizer of each query row,
+// which is all the backward pass needs to rebuild the probabilities.
+void attention_forward(const AttentionConfig& config,
+                       const std::vector<float>& q, const std::vector<float>& k, const std::vector<float>& v,
+                       std::vector<float>& out, std::vector<float>& logsumexp);
+
+// Gradients of attention_forward, recomputing the scores tile by tile.
+void attention_backward(const AttentionConfig& config,
+                        const std::vector<float>& q, const std::vector<float>& k, const std::vector<float>& v,
+                        const std::vector<float>& out, const std::vector<float>& logsumexp,
+                        const std::vector<float>& grad_out,
+                        std::vector<float>& grad_q, std::vector<float>& grad_k, std::vector<float>& grad_v);
+
+// batch x len x (heads * head_dim)  <->  batch x heads x len x head_dim
+std::vector<float> split_heads(const std::vector<float>& x, int batch, int len, int heads, int head_dim);
+std::vector<float> merge_heads(const std::vector<float>& x, int batch, int len, int heads, int head_dim);
@@ -0,0 +1,80 @@
+//
+//  calibration.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "network.h"
+#include "preprocessing.h"
+#include "quantization.h"
+
+// Post-training quantization: the scales of the int8 activations of a model, chosen from the
+// values they take on a calibration set.
+// Calibrator runs batches of that set through the layers in float and keeps, for the input and
+// the output of every layer, a RunningStats and a StreamingHistogram of the values, so the set
+// is streamed and never held in memory. The quantization parameters of each tensor are then
+// derived from the statistics by one of the methods below.
+//     Calibrator calibrator(mlp.layers());
+//     for (const auto& batch : calibration_set) calibrator.observe(batch, batch_size);
+//     std::vector<QuantizedDense> int8_layers = quantize_layers(mlp.layers(), calibrator.params(CalibrationMethod::MinMax));
+// No method is best everywhere, compare them on held-out data (./benchmark_script.sh calibration
+// does it for a small ReLU MLP): on clean N(0, 1) inputs min-max and percentile are within 1.4%
+// of the float output and entropy 17%, with rare large outliers in the calibration set entropy
+// is the most accurate (3%, min-max 13%).
+
+enum class CalibrationMethod {
+    // The range of every value seen. Exact for the calibration set, but one outlier widens the
+    // scale of every other value.
+    MinMax,
+    // Clip magnitudes above a percentile of |x| (99.99 by default).
+    Percentile,
+    // Clip at the threshold whose quantized distribution is closest to the observed one in
+    // Kullback-Leibler divergence, as TensorRT does. Robust to outliers, but it clips hard: on
+    // ReLU outputs (a large spike at 0) it typically keeps less than half of the range.
+    Entropy
+};
+
+// Affine parameters covering [min, max], widened to include 0 so that 0 is exact (zero padding,
+// ReLU outputs). A one-sided range gets all 256 levels.
+QuantParams range_quant_params(float min, float max);
+
+// Threshold on |x| minimizing KL(P || Q), with P the histogram clipped at the threshold (the
+// counts beyond it added to the last bin) and Q that histogram quantized to levels bins.
+// Thresholds are the bin edges from levels bins up; a histogram with fewer bins than levels
+// returns its limit.
+float entropy_threshold(const StreamingHistogram& histogram, int levels);
+
+class Calibrator {
+public:
+    // layers must outlive the calibrator
+    explicit Calibrator(const std::vector<Dense>& layers, int histogram_bins = 2048);
+
+    // Runs a batch (batch x in_features of the first layer) through the layers and records the
+    // input and every layer output
+    void observe(const std::vector<float>& input, int batch);
+
+    // Tensor 0 is the input, tensor l + 1 the output of layer l
+    size_t tensors() const { return stats_.size(); }
+    const RunningStats& stats(size_t tensor) const { return stats_.at(tensor); }
+    const StreamingHistogram& histogram(size_t tensor) const { return histograms_.at(tensor); }
+
+    // Throws std::logic_error if nothing was observed, std::out_of_range for a bad tensor
+    QuantParams params(size_t tensor, CalibrationMethod method, float percentile = 99.99f) const;
+    // Parameters of every tensor, in the order quantize_layers expects
+    std::vector<QuantParams> params(CalibrationMethod method, float percentile = 99.99f) const;
+
+private:
+    const std::vector<Dense>* layers_;
+    std::vector<RunningStats> stats_;
+    std::vector<StreamingHistogram> histograms_;
+    std::vector<float> buffers_[2];
+};
+
+// Int8 layers chained by params (layers.size() + 1 entries): layer l reads tensor l and writes
+// tensor l + 1, so the output of one is the input of the next without requantizing.
+std::vector<QuantizedDense> quantize_layers(const std::vector<Dense>& layers, const std::vector<QuantParams>& params);
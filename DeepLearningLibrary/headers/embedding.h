@@ -0,0 +1,104 @@
+//
+//  embedding.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Row-sparse gradient of an embedding table.
+// indices are sorted and unique, values holds one row of size dim per index.
+struct SparseGradient {
+    int dim = 0;
+    std::vector<int> indices;
+    std::vector<float> values;
+};
+
+// Hit-rate counters of the hot-row cache of a memory-mapped embedding table.
+struct EmbeddingCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t admissions = 0;
+    size_t evictions = 0;
+    size_t prefetched_pages = 0;
+
+    double hit_rate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+};
+
+struct MappedTable;
+
+// Embedding layer: maps integer ids to rows of a num_embeddings x dim table.
+// The backward pass produces a SparseGradient, so a training step only touches
+// the rows whose ids appeared in the batch.
+//
+// The table either lives in RAM (weights) or, for tables larger than RAM, in a file of raw float
+// rows that is memory-mapped (see create_mapped/open_mapped). In the mapped mode a small cache of
+// hot rows is kept in RAM so the frequent ids do not depend on the page cache, and prefetch() tells
+// the kernel which pages the next mini-batch will read.
+class Embedding {
+public:
+    Embedding(int num_embeddings, int dim, unsigned seed = 42);
+    Embedding(Embedding&&) noexcept;
+    Embedding& operator=(Embedding&&) noexcept;
+    ~Embedding();
+
+    // Create a table file of num_embeddings x dim random rows and map it.
+    static Embedding create_mapped(const std::string& path, int num_embeddings, int dim,
+                                   size_t cache_rows = 0, unsigned seed = 42);
+    // Map an existing table file. Writes from the optimizers go back to the file.
+    static Embedding open_mapped(const std::string& path, int num_embeddings, int dim,
+                                 size_t cache_rows = 0);
+
+    // output[i] = table[ids[i]], output is ids.size() x dim
+    void forward(const std::vector<int>& ids, std::vector<float>& output) const;
+    // grad_output is ids.size() x dim. Rows of repeated ids are summed.
+    SparseGradient backward(const std::vector<int>& ids, const std::vector<float>& grad_output) const;
+
+    // Pointer to the row of id. In the mapped mode the pointer may be a hot-row cache slot
+    // and is only valid until the next row access.
+    float* row(int id);
+    const float* row(int id) const;
+
+    // Mapped mode: advise the kernel to read the pages of the rows of the upcoming ids
+    // (madvise WILLNEED), so they are loaded while the current batch is being computed.
+    void prefetch(const std::vector<int>& upcoming_ids) const;
+    // Mapped mode: write the dirty cached rows back and sync the file.
+    void flush();
+
+    bool is_mapped() const { return table_ != nullptr; }
+    EmbeddingCacheStats cache_stats() const;
+    void reset_cache_stats();
+
+    int num_embeddings;
+    int dim;
+    std::vector<float> weights;
+
+private:
+    Embedding(int num_embeddings, int dim, std::unique_ptr<MappedTable> table);
+
+    std::unique_ptr<MappedTable> table_;
+};
+
+// Sparse optimizers, they only update the rows listed in the gradient.
+
+// table[i] -= learning_rate * grad[i]
+void sparse_sgd_update(Embedding& embedding, const SparseGradient& grad, float learning_rate);
+
+// Adagrad with one accumulator per element; accumulators of rows that are
+// not in the gradient are left untouched.
+class SparseAdagrad {
+public:
+    SparseAdagrad(const Embedding& embedding, float learning_rate = 0.01f, float epsilon = 1e-10f);
+    void step(Embedding& embedding, const SparseGradient& grad);
+
+private:
+    float learning_rate_;
+    float epsilon_;
+    std::vector<float> accumulators_;
+};
@@ -0,0 +1,229 @@
+//
+//  expression.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include "vector_math.h"
+#include "thread_pool.h"
+
+// Lazy elementwise expressions over float buffers.
+// sigmoid(lazy(a)) * b + c builds a tree of small node objects instead of computing anything;
+// the whole tree is evaluated in one loop when it is assigned:
+//     lazy(out) = sigmoid(lazy(a)) * b + c;
+// Every node is its own type, so the loop body is the fully inlined expression
+// fast_sigmoid(a[i]) * b[i] + c[i] for this exact tree: no temporaries, one pass over memory,
+// and the loop vectorizes. Nodes hold their children by value and the leaves only point to
+// the vectors, which must outlive the expression.
+// Operands must have the same size (scalars match any size), else std::invalid_argument.
+// lazy(out) may also appear on the right-hand side: element i is read before it is written.
+
+// Size of a scalar operand, it matches any size
+const size_t SCALAR_SIZE = (size_t)-1;
+
+// CRTP base, the operators below only accept expressions
+template <typename E>
+struct Expr {
+    const E& self() const { return static_cast<const E&>(*this); }
+    size_t size() const { return self().size(); }
+    float operator[](size_t i) const { return self()[i]; }
+};
+
+struct VectorLeaf : Expr<VectorLeaf> {
+    const float* data;
+    size_t n;
+    VectorLeaf(const float* data, size_t n) : data(data), n(n) {}
+    size_t size() const { return n; }
+    float operator[](size_t i) const { return data[i]; }
+};
+
+struct ScalarLeaf : Expr<ScalarLeaf> {
+    float value;
+    explicit ScalarLeaf(float value) : value(value) {}
+    size_t size() const { return SCALAR_SIZE; }
+    float operator[](size_t) const { return value; }
+};
+
+template <typename Op, typename E>
+struct UnaryNode : Expr<UnaryNode<Op, E>> {
+    E operand;
+    explicit UnaryNode(const E& operand) : operand(operand) {}
+    size_t size() const { return operand.size(); }
+    float operator[](size_t i) const { return Op::apply(operand[i]); }
+};
+
+template <typename Op, typename L, typename R>
+struct BinaryNode : Expr<BinaryNode<Op, L, R>> {
+    L left;
+    R right;
+    BinaryNode(const L& left, const R& right) : left(left), right(right)
+    {
+        if (left.size() != right.size() && left.size() != SCALAR_SIZE && right.size() != SCALAR_SIZE) {
+            throw std::invalid_argument("Expression operands must have the same size.");
+        }
+    }
+    size_t size() const { return left.size() != SCALAR_SIZE ? left.size() : right.size(); }
+    float operator[](size_t i) const { return Op::apply(left[i], right[i]); }
+};
+
+// Assignable leaf over a mutable vector
+struct VectorRef : Expr<VectorRef> {
+    std::vector<float>* target;
+    explicit VectorRef(std::vector<float>& target) : target(&target) {}
+    size_t size() const { return target->size(); }
+    float operator[](size_t i) const { return (*target)[i]; }
+
+    // Evaluates the expression into the vector, resizing it to the expression size
+    template <typename E>
+    VectorRef& operator=(const Expr<E>& expression);
+    // lazy(out) = lazy(a) copies a into out. The implicit copy assignment would be chosen over
+    // the template and only rebind the temporary.
+    VectorRef(const VectorRef&) = default;
+    VectorRef& operator=(const VectorRef& other) { return operator=(static_cast<const Expr<VectorRef>&>(other)); }
+};
+
+inline VectorLeaf lazy(const std::vector<float>& v) { return VectorLeaf(v.data(), v.size()); }
+inline VectorRef lazy(std::vector<float>& v) { return VectorRef(v); }
+inline VectorLeaf lazy(const float* data, size_t n) { return VectorLeaf(data, n); }
+
+// Leaf or node as stored in a parent: vectors become leaves, floats scalar leaves
+template <typename T> struct Operand { typedef T type; static const T& wrap(const T& e) { return e; } };
+template <> struct Operand<std::vector<float>> {
+    typedef VectorLeaf type;
+    static VectorLeaf wrap(const std::vector<float>& v) { return lazy(v); }
+};
+template <> struct Operand<float> {
+    typedef ScalarLeaf type;
+    static ScalarLeaf wrap(float v) { return ScalarLeaf(v); }
+};
+// A VectorRef on the right-hand side is read like a leaf
+template <> struct Operand<VectorRef> {
+    typedef VectorLeaf type;
+    static VectorLeaf wrap(const VectorRef& v) { return VectorLeaf(v.target->data(), v.target->size()); }
+};
+
+// Elementwise operations, branch-free so the loops vectorize
+struct AddOp { static float apply(float a, float b) { return a + b; } };
+struct SubOp { static float apply(float a, float b) { return a - b; } };
+struct MulOp { static float apply(float a, float b) { return a * b; } };
+struct DivOp { static float apply(float a, float b) { return a / b; } };
+struct MinOp { static float apply(float a, float b) { return a < b ? a : b; } };
+struct MaxOp { static float apply(float a, float b) { return a > b ? a : b; } };
+struct NegOp { static float apply(float x) { return -x; } };
+struct ReluOp { static float apply(float x) { return x > 0.0f ? x : 0.0f; } };
+struct SigmoidOp { static float apply(float x) { return fast_sigmoid(x); } };
+struct TanhOp { static float apply(float x) { return fast_tanh(x); } };
+struct ExpOp { static float apply(float x) { return fast_exp(x); } };
+struct SinOp { static float apply(float x) { return fast_sin(x); } };
+struct Relu6Op { static float apply(float x) { float y = x > 0.0f ? x : 0.0f; return y < 6.0f ? y : 6.0f; } };
+struct HardsigmoidOp { static float apply(float x) { return Relu6Op::apply(x + 3.0f) * (1.0f / 6.0f); } };
+struct HardswishOp { static float apply(float x) { return x * HardsigmoidOp::apply(x); } };
+struct SiluOp { static float apply(float x) { return x * fast_sigmoid(x); } };
+
+template <typename Op, typename E>
+UnaryNode<Op, typename Operand<E>::type> make_unary(const E& e)
+{
+    return UnaryNode<Op, typename Operand<E>::type>(Operand<E>::wrap(e));
+}
+
+template <typename E>
+auto operator-(const Expr<E>& e) { return make_unary<NegOp>(e.self()); }
+
+#define DLLIB_LAZY_UNARY(name, Op)                                                  \
+    template <typename E>                                                           \
+    auto name(const Expr<E>& e) { return make_unary<Op>(e.self()); }                \
+    inline auto name(const std::vector<float>& v) { return make_unary<Op>(v); }
+
+DLLIB_LAZY_UNARY(relu, ReluOp)
+DLLIB_LAZY_UNARY(sigmoid, SigmoidOp)
+DLLIB_LAZY_UNARY(dllib_tanh, TanhOp)
+DLLIB_LAZY_UNARY(lazy_exp, ExpOp)
+DLLIB_LAZY_UNARY(sinusoid, SinOp)
+DLLIB_LAZY_UNARY(relu6, Relu6Op)
+DLLIB_LAZY_UNARY(hardsigmoid, HardsigmoidOp)
+DLLIB_LAZY_UNARY(hardswish, HardswishOp)
+DLLIB_LAZY_UNARY(swish, SiluOp)
+#undef DLLIB_LAZY_UNARY
+
+// Binary operators between an expression and an expression, a vector or a float, either side
+template <typename Op, typename L, typename R>
+BinaryNode<Op, typename Operand<L>::type, typename Operand<R>::type> make_binary(const L& l, const R& r)
+{
+    return BinaryNode<Op, typename Operand<L>::type, typename Operand<R>::type>(Operand<L>::wrap(l), Operand<R>::wrap(r));
+}
+
+#define DLLIB_LAZY_BINARY(name, Op)                                                                           \
+    template <typename L, typename R>                                                                         \
+    auto name(const Expr<L>& l, const Expr<R>& r) { return make_binary<Op>(l.self(), r.self()); }             \
+    template <typename L>                                                                                     \
+    auto name(const Expr<L>& l, const std::vector<float>& r) { return make_binary<Op>(l.self(), r); }         \
+    template <typename R>                                                                                     \
+    auto name(const std::vector<float>& l, const Expr<R>& r) { return make_binary<Op>(l, r.self()); }         \
+    template <typename L>                                                                                     \
+    auto name(const Expr<L>& l, float r) { return make_binary<Op>(l.self(), r); }                             \
+    template <typename R>                                                                                     \
+    auto name(float l, const Expr<R>& r) { return make_binary<Op>(l, r.self()); }
+
+DLLIB_LAZY_BINARY(operator+, AddOp)
+DLLIB_LAZY_BINARY(operator-, SubOp)
+DLLIB_LAZY_BINARY(operator*, MulOp)
+DLLIB_LAZY_BINARY(operator/, DivOp)
+DLLIB_LAZY_BINARY(lazy_min, MinOp)
+DLLIB_LAZY_BINARY(lazy_max, MaxOp)
+#undef DLLIB_LAZY_BINARY
+
+// The single loop every expression is evaluated with
+template <typename E>
+void evaluate_into(float* out, const Expr<E>& expression)
+{
+    const E& e = expression.self();
+    size_t n = e.size();
+    if (n == SCALAR_SIZE) {
+        throw std::invalid_argument("An expression needs at least one vector operand.");
+    }
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        const E local = e;
+        for (size_t i = begin; i < end; ++i) {
+            out[i] = local[i];
+        }
+    });
+}
+
+template <typename E>
+std::vector<float> evaluate(const Expr<E>& expression)
+{
+    std::vector<float> out(expression.size() == SCALAR_SIZE ? 0 : expression.size());
+    evaluate_into(out.data(), expression);
+    return out;
+}
+
+template <typename E>
+VectorRef& VectorRef::operator=(const Expr<E>& expression)
+{
+    if (expression.size() != SCALAR_SIZE) {
+        target->resize(expression.size());
+    }
+    evaluate_into(target->data(), expression);
+    return *this;
+}
+
+// Sum of an expression, one pass and no temporary
+template <typename E>
+float sum(const Expr<E>& expression)
+{
+    const E& e = expression.self();
+    return parallel_reduce(0, e.size(), ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        const E local = e;
+        float s = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            s += local[i];
+        }
+        return s;
+    }, [](float a, float b) { return a + b; });
+}
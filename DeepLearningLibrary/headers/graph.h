@@ -0,0 +1,156 @@
+//
+//  graph.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "network.h"
+#include "huge_pages.h"
+#include "packed_gemm.h"
+
+// Static inference graph.
+// The graph is built once (nodes added in execution order, each returning the id of the tensor it
+// produces), then compiled for a maximum batch size. Compiling runs a liveness analysis over the
+// intermediate tensors and packs them into one preallocated arena: two tensors whose lifetimes do
+// not overlap may share the same offsets, and an elementwise node whose input dies at that node
+// writes over its input. After compile(), run() does no heap allocation.
+// Every tensor is batch x features, row-major.
+// fuse() merges chains of elementwise nodes into the node that produces their input, so the chain
+// runs as one loop over memory instead of one pass per node.
+
+// Per-row losses a graph can end with, averaged over the features of the row
+enum class GraphLoss { MeanSquaredError, MeanAbsoluteError, BinaryCrossEntropy };
+
+// What fuse() did
+struct FusionReport {
+    int nodes_before = 0;
+    int nodes_after = 0;
+    // Full passes over an intermediate tensor that no longer happen (one per node merged away)
+    int memory_passes_saved = 0;
+    // Sigmoid followed by binary cross-entropy, computed from the logits instead
+    int sigmoid_cross_entropy_rewrites = 0;
+};
+
+class InferenceGraph {
+public:
+    explicit InferenceGraph(int input_features);
+
+    // The graph input, tensor 0. run() reads it from the caller's buffer, it is not copied.
+    int input() const { return 0; }
+
+    // y = x * W + b with the weights of layer, followed by layer.activation as a separate node.
+    // The graph keeps its own copy of the weights.
+    int dense(int x, const Dense& layer);
+    // Same with weights (in x out_features) and bias (out_features) used in place, not copied,
+    // e.g. tensors of a WeightFile. They must stay valid as long as the graph runs.
+    int dense(int x, int out_features, const float* weights, const float* bias,
+              Activation activation = Activation::Identity);
+    // Same with weights packed for gemm_packed (e.g. from a PackedWeightCache), used in place
+    int dense(int x, const PackedMatrix& weights, const float* bias,
+              Activation activation = Activation::Identity);
+    int activation(int x, Activation activation);
+    // Elementwise sum of two tensors of the same width (residual connection)
+    int add(int a, int b);
+    // y = x * scale + shift
+    int scale_shift(int x, float scale, float shift);
+    // Second external input holding the targets of a loss, read from the targets buffer of run()
+    int targets(int features);
+    // Per-row loss between x and targets, a batch x 1 tensor
+    int loss(int x, int targets, GraphLoss kind);
+    // The tensor returned by run(). Defaults to the last node added.
+    void set_output(int x);
+
+    // Merge elementwise chains into their producer. Call it after the last node and before compile().
+    FusionReport fuse();
+
+    // Plan the arena for batches of up to max_batch rows and allocate it.
+    void compile(int max_batch);
+    // Runs the graph on batch rows of input_features. The result stays valid until the next run.
+    const float* run(const float* input, int batch);
+    const float* run(const std::vector<float>& input, int batch);
+    const float* run(const float* input, const float* targets, int batch);
+
+    int output_features() const;
+    // Arena size after planning, and the size with one buffer per intermediate tensor
+    size_t arena_bytes() const { return arena_.size() * sizeof(float); }
+    size_t unplanned_bytes() const;
+
+private:
+    // Dense: y = steps(x * W + b). Elementwise: y = steps(x). Loss: y = loss(steps(x), targets).
+    enum class OpKind { Dense, Elementwise, Loss };
+
+    // One elementwise step, applied to the running value of each element
+    struct Step {
+        enum Kind { Activate, ScaleShift, AddTensor } kind;
+        Activation activation = Activation::Identity;
+        float scale = 1.0f;
+        float shift = 0.0f;
+        int tensor = -1;
+    };
+
+    // inputs[0] is the tensor the node streams through, the others are read by its steps
+    // (AddTensor) or are the loss targets (last).
+    struct Op {
+        OpKind kind;
+        std::vector<int> inputs;
+        int output;
+        int layer = -1;
+        std::vector<Step> steps{};
+        GraphLoss loss = GraphLoss::MeanSquaredError;
+    };
+
+    struct Tensor {
+        int features;
+        int producer;         // op index, -1 for the input
+        int storage = -1;     // arena slot, shared by in-place nodes
+    };
+
+    struct Storage {
+        size_t floats_per_row;
+        int first_op;
+        int last_op;
+        size_t offset = 0;    // in floats, from the start of the arena
+    };
+
+    // Either owned (copied from a Dense) or borrowed (external pointers, or a packed matrix)
+    struct Weights {
+        int in_features;
+        int out_features;
+        std::vector<float> weights{};
+        std::vector<float> bias{};
+        const float* external_weights = nullptr;
+        const float* external_bias = nullptr;
+        const PackedMatrix* packed = nullptr;
+
+        const float* weight_data() const { return external_weights ? external_weights : weights.data(); }
+        const float* bias_data() const { return external_bias ? external_bias : bias.data(); }
+    };
+
+    int add_tensor(int features, int producer);
+    int add_dense(int x, Weights weights, Activation activation);
+    const Tensor& tensor(int id) const;
+    int add_elementwise(int x, const Step& step, int side_input);
+    float* data(int id) const;
+    void apply_steps(const Step* first, const Step* last, float* y, size_t offset, size_t n) const;
+    void run_dense(const Op& op, int batch);
+    void run_elementwise(const Op& op, int batch);
+    void run_loss(const Op& op, int batch);
+    void plan_storage();
+
+    std::vector<Tensor> tensors_;
+    std::vector<Op> ops_;
+    std::vector<Weights> layers_;
+    std::vector<Storage> storage_;
+    int output_ = -1;
+    int targets_ = -1;
+    int max_batch_ = 0;
+    // External buffers of the current run()
+    const float* input_data_ = nullptr;
+    const float* targets_data_ = nullptr;
+    huge_vector<float> arena_;
+};
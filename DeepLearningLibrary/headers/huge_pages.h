@@ -0,0 +1,82 @@
+//
+//  huge_pages.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Huge page backed allocation for large buffers.
+// With 4 KB pages a 1 GB buffer needs 262144 TLB entries, so random or strided access over it
+// misses the TLB on almost every load; with 2 MB pages it needs 512.
+// Buffers of at least HUGE_PAGE_THRESHOLD bytes are mapped 2 MB aligned and, depending on the
+// mode, advised as transparent huge pages (MADV_HUGEPAGE) or taken from the hugetlbfs pool
+// (MAP_HUGETLB, needs pages reserved in /proc/sys/vm/nr_hugepages). Smaller buffers use operator new.
+// Linux only; elsewhere every buffer uses operator new.
+
+const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+const size_t HUGE_PAGE_THRESHOLD = size_t(4) << 20;
+
+enum class HugePageMode {
+    // 2 MB aligned mappings on regular pages
+    Off,
+    // madvise(MADV_HUGEPAGE) only
+    Transparent,
+    // madvise(MADV_HUGEPAGE), or hugetlbfs pages when transparent huge pages are disabled
+    TransparentOrHugeTlb,
+};
+
+// What a large allocation ended up with
+enum class PageKind { Regular, Transparent, HugeTlb };
+
+// Applies to the allocations made afterwards. Default TransparentOrHugeTlb.
+void configure_huge_pages(HugePageMode mode);
+HugePageMode huge_page_mode();
+
+// bytes >= HUGE_PAGE_THRESHOLD only. Throws std::bad_alloc.
+// With transparent huge pages the kernel may still back some of the range with regular pages
+// (fragmented memory); kind reports what was asked for.
+void* huge_page_alloc(size_t bytes, PageKind* kind = nullptr);
+void huge_page_free(void* data, size_t bytes);
+
+// Standard allocator that sends buffers of at least HUGE_PAGE_THRESHOLD bytes to huge_page_alloc
+template <typename T>
+struct HugePageAllocator {
+    typedef T value_type;
+
+    HugePageAllocator() = default;
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        size_t bytes = n * sizeof(T);
+        if (bytes >= HUGE_PAGE_THRESHOLD) {
+            return static_cast<T*>(huge_page_alloc(bytes));
+        }
+        return static_cast<T*>(::operator new(bytes));
+    }
+
+    void deallocate(T* data, size_t n)
+    {
+        size_t bytes = n * sizeof(T);
+        if (bytes >= HUGE_PAGE_THRESHOLD) {
+            huge_page_free(data, bytes);
+        } else {
+            ::operator delete(data);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using huge_vector = std::vector<T, HugePageAllocator<T>>;
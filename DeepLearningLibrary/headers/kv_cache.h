@@ -0,0 +1,71 @@
+//
+//  kv_cache.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "huge_pages.h"
+
+// Paged key/value cache for autoregressive decoding.
+// All the memory is allocated once, as a pool of pages of page_size tokens. A page stores the keys
+// (and, in a second pool, the values) of its tokens head by head: heads x page_size x head_dim,
+// so the keys of one head inside a page are a contiguous page_size x head_dim block.
+// Each sequence owns a list of pages (its page table); appending a token only allocates a page
+// when the last one is full, and truncating returns the pages past the new end to the pool.
+// Decoding reads pages scattered over the pools, so large pools are backed by huge pages.
+class KVCache {
+public:
+    KVCache(int heads, int head_dim, int max_tokens, int page_size = 16);
+
+    // A new empty sequence, returns its id
+    int add_sequence();
+    // Return all pages of a sequence to the pool, the id can not be used afterwards
+    void release_sequence(int seq);
+
+    // Append one token, key and value are heads x head_dim.
+    // Throws std::length_error when the pool has no free page left.
+    void append(int seq, const float* key, const float* value);
+    void append(int seq, const std::vector<float>& key, const std::vector<float>& value);
+    // Keep the first length tokens of the sequence (e.g. to roll back rejected draft tokens)
+    void truncate(int seq, int length);
+
+    int length(int seq) const;
+    int free_pages() const { return (int)free_pages_.size(); }
+    int heads() const { return heads_; }
+    int head_dim() const { return head_dim_; }
+    int page_size() const { return page_size_; }
+
+    // Keys/values of head h in the n-th page of a sequence, page_size x head_dim
+    const float* key_block(int seq, int n, int h) const;
+    const float* value_block(int seq, int n, int h) const;
+
+private:
+    struct Sequence {
+        bool active = false;
+        int length = 0;
+        std::vector<int> pages;
+    };
+    const Sequence& sequence(int seq) const;
+    Sequence& sequence(int seq);
+    size_t page_offset(int page, int h) const;
+
+    int heads_;
+    int head_dim_;
+    int page_size_;
+    huge_vector<float> keys_;
+    huge_vector<float> values_;
+    std::vector<int> free_pages_;
+    std::vector<Sequence> sequences_;
+};
+
+// Attention of one new query token (heads x head_dim) over all the cached tokens of a sequence,
+// page by page with an online softmax, out is heads x head_dim.
+// The cost is linear in the sequence length. Append the token's own key and value first
+// if it should attend to itself.
+void decode_attention(const KVCache& cache, int seq, const std::vector<float>& query,
+                      std::vector<float>& out, float scale = 0.0f);
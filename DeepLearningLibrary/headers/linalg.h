@@ -0,0 +1,19 @@
+//
+//  linalg.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+// Dense linear algebra on row-major float buffers.
+
+// General matrix multiply: C = alpha * op(A) * op(B) + beta * C
+// op(A) is m x k, op(B) is k x n and C is m x n.
+// lda, ldb and ldc are the row strides of A, B and C as they are stored (before op).
+// With beta == 0 the previous content of C is ignored, even if it is NaN.
+void gemm(bool trans_a, bool trans_b, int m, int n, int k,
+          float alpha, const float* a, int lda,
+          const float* b, int ldb,
+          float beta, float* c, int ldc);
@@ -1,5 +1,6 @@
 #include <vector>
 #include <iostream>
+#include "sequence.h"
 
 float mean_squared_error(const std::vector<float>& predictions, const std::vector<float>& targets);
 float binary_cross_entropy(const std::vector<float>& predictions, const std::vector<float>& targets);   
@@ -8,4 +9,8 @@ float categorical_cross_entropy(const std::vector<std::vector<float>>& predictio
 float sparse_categorical_cross_entropy(const std::vector<std::vector<float>>& predictions, const std::vector<int>& targets);
 float kullback_leibler_divergence(const std::vector<std::vector<float>>& predictions, const std::vector<std::vector<float>>& targets);
 float hinge_loss(const std::vector<float>& predictions, const std::vector<int>& targets);
-float huber_loss(const std::vector<float>& predictions, const std::vector<float>& targets, float delta = 1.0f);
\ No newline at end of file
+float huber_loss(const std::vector<float>& predictions, const std::vector<float>& targets, float delta = 1.0f);
+
+// Losses over packed variable-length sequences, averaged over the real tokens (no padding).
+float packed_mean_squared_error(const PackedSequence& predictions, const PackedSequence& targets);
+float packed_sparse_categorical_cross_entropy(const PackedSequence& predictions, const std::vector<int>& targets);
@@ -0,0 +1,128 @@
+//
+//  network.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Activations a layer can apply in place.
+// They are limited to the ones whose gradient can be computed from the output,
+// so a layer only has to keep its output for the backward pass.
+enum class Activation {
+    Identity,
+    ReLU,
+    Sigmoid,
+    Tanh,
+    ELU,
+    Softplus,
+    ReLU6,
+    Hardtanh,
+    Hardsigmoid
+};
+
+void activation_forward_inplace(Activation activation, float* x, size_t n);
+void activation_forward_inplace(Activation activation, std::vector<float>& x);
+void activation_backward_inplace(Activation activation, const std::vector<float>& output, std::vector<float>& grad);
+
+// Fully connected layer: y = activation(x * W + b)
+// x is batch x in_features, W is in_features x out_features, y is batch x out_features (row-major).
+struct Dense {
+    int in_features;
+    int out_features;
+    Activation activation;
+    std::vector<float> weights;
+    std::vector<float> bias;
+    std::vector<float> grad_weights;
+    std::vector<float> grad_bias;
+
+    Dense(int in_features, int out_features, Activation activation = Activation::Identity, unsigned seed = 42);
+
+    void forward(const std::vector<float>& input, std::vector<float>& output, int batch) const;
+    // grad_output holds dL/dy on entry and is overwritten with dL/dz (pre-activation).
+    // Parameter gradients are accumulated, grad_input receives dL/dx.
+    void backward(const std::vector<float>& input, const std::vector<float>& output,
+                  std::vector<float>& grad_output, std::vector<float>& grad_input, int batch);
+    void zero_grad();
+};
+
+// Channel-wise PReLU: y = x if x > 0, alpha[c] * x otherwise, with one learnable slope per channel.
+// Data is NHWC (channels last), so the channel of element i is i % channels and any
+// batch x height x width x channels buffer works.
+struct ChannelPReLU {
+    int channels;
+    std::vector<float> alpha;
+    std::vector<float> grad_alpha;
+
+    explicit ChannelPReLU(int channels, float initial_alpha = 0.25f);
+
+    void forward(const std::vector<float>& input, std::vector<float>& output) const;
+    // grad_input receives dL/dx, dL/dalpha is accumulated into grad_alpha.
+    void backward(const std::vector<float>& input, const std::vector<float>& grad_output,
+                  std::vector<float>& grad_input);
+    void zero_grad();
+};
+
+// Radial basis function layer: y[b][k] = exp(-gamma * ||x_b - c_k||^2)
+// the gaussian activation applied to the distance between each input row and each center.
+// x is batch x in_features, the centers are num_centers x in_features, y is batch x num_centers.
+struct RBF {
+    int in_features;
+    int num_centers;
+    float gamma;
+    std::vector<float> centers;
+    std::vector<float> grad_centers;
+
+    RBF(int in_features, int num_centers, float gamma = 1.0f, unsigned seed = 42);
+
+    void forward(const std::vector<float>& input, std::vector<float>& output, int batch) const;
+    // output is the result of forward(). grad_input receives dL/dx, dL/dc is accumulated.
+    void backward(const std::vector<float>& input, const std::vector<float>& output,
+                  const std::vector<float>& grad_output, std::vector<float>& grad_input, int batch);
+    void zero_grad();
+};
+
+// Multi-layer perceptron with optional activation checkpointing.
+// Activation i is the input of layer i (activation 0 is the network input, activation L the output).
+// With checkpointing enabled, only the activations marked as checkpoints are kept after the forward
+// pass; the others are recomputed segment by segment during the backward pass, trading one extra
+// forward through each segment for the memory of its intermediates.
+class MLP {
+public:
+    // sizes = {input, hidden..., output}
+    MLP(const std::vector<int>& sizes, Activation hidden_activation,
+        Activation output_activation = Activation::Identity, unsigned seed = 42);
+
+    const std::vector<float>& forward(const std::vector<float>& input, int batch);
+    // Backpropagates dL/d(output) through the network, accumulating the layer gradients,
+    // and returns dL/d(input).
+    std::vector<float> backward(const std::vector<float>& grad_output);
+    void zero_grad();
+
+    // Mark which activations are kept (size L + 1). The input and the output are always kept.
+    void set_checkpoints(const std::vector<bool>& keep);
+    // Choose the checkpoints that need the least recomputation while keeping the activation
+    // memory of a training step under memory_budget_bytes. If no plan fits, the plan with the
+    // smallest peak is used. Returns the estimated peak in bytes.
+    size_t plan_checkpoints(size_t memory_budget_bytes, int batch);
+    // Keep every activation, nothing is recomputed.
+    void disable_checkpointing();
+    // Estimated peak activation memory of a training step with the current checkpoints.
+    size_t peak_activation_bytes(int batch) const;
+
+    const std::vector<bool>& checkpoints() const { return keep_; }
+    std::vector<Dense>& layers() { return layers_; }
+
+private:
+    size_t peak_activation_bytes(const std::vector<bool>& keep, int batch) const;
+    void recompute_segment(int start, int end);
+
+    std::vector<Dense> layers_;
+    std::vector<bool> keep_;
+    std::vector<std::vector<float>> activations_;
+    int batch_ = 0;
+};
@@ -0,0 +1,49 @@
+//
+//  numa.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "thread_pool.h"
+
+// NUMA placement of buffers processed by the thread pool.
+// A parallel_for first splits its chunks evenly between the pool threads: thread i starts with
+// chunks [chunks * i / n, chunks * (i + 1) / n) (see pool_chunk_owner). With pinned workers and
+// the pages of each such range on the node of the thread that owns it, every thread streams
+// local memory, and stealing goes to threads of the same node first.
+// Everything here is Linux only; elsewhere there is a single node and the calls do nothing.
+
+// Nodes of the machine and the CPUs of each node, read from /sys/devices/system/node.
+int numa_node_count();
+const std::vector<int>& numa_node_cpus(int node);
+// Node of a CPU, 0 if unknown.
+int numa_node_of_cpu(int cpu);
+
+// The placement functions only act on the pages lying entirely inside the buffer: the partial
+// pages at its ends stay where they are, since they are shared with neighbouring allocations.
+// Page-aligned buffers (huge_vector) are placed completely.
+
+// Move the pages of [data, data + bytes) to node (mbind with MPOL_BIND and MPOL_MF_MOVE).
+// Returns false if the kernel refused, e.g. without NUMA support.
+bool numa_bind(void* data, size_t bytes, int node);
+// Spread the pages of [data, data + bytes) round-robin over every node.
+bool numa_interleave(void* data, size_t bytes);
+
+// Place the pages of a buffer processed by parallel_for with chunks of grain_bytes on the node of
+// the pool thread that starts with them. Pages already in memory are migrated.
+bool numa_place_for_pool(void* data, size_t bytes, size_t grain_bytes);
+
+template <typename T>
+bool numa_place_for_pool(std::vector<T>& buffer, size_t grain = ELEMENTWISE_GRAIN)
+{
+    return numa_place_for_pool(buffer.data(), buffer.size() * sizeof(T), grain * sizeof(T));
+}
+
+// First touch of fresh memory (never written, e.g. straight from mmap): zero-fills it with
+// parallel_for, so each page is allocated on the node of the pool thread that starts with it.
+void numa_first_touch(void* data, size_t bytes, size_t grain_bytes);
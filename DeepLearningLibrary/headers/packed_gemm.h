@@ -0,0 +1,92 @@
+//
+//  packed_gemm.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <unordered_map>
+#include "huge_pages.h"
+#include "weight_file.h"
+
+// GEMM on weights packed once into panels.
+// gemm() reads B row by row from the weight matrix as stored. Here B (k x n) is rearranged once
+// into panels of nr columns and kc rows, each contiguous, in the order the micro-kernel reads
+// them: a kernel call keeps an mr x nr block of C in registers and streams one panel from L1.
+// The panel shape depends on the instruction set of the kernel (the AVX2 kernel holds 6 x 16
+// floats of C in twelve 256-bit registers), so a packed matrix is only valid for the layout it
+// was packed for.
+// Packing a large model takes seconds, so PackedWeightCache keeps the packed weights in a weight
+// file next to the model, named after the layout, and maps it on the next start.
+
+struct GemmLayout {
+    // Instruction set of the kernel, "avx2-fma" or "generic"
+    std::string isa;
+    int mr;
+    int nr;
+    int kc;
+
+    // Names the layout in cache file names, e.g. "avx2-fma.mr6.nr16.kc256"
+    std::string key() const;
+};
+
+// Layout of the fastest kernel this CPU supports, chosen on first use.
+// DLLIB_GEMM_ISA=generic forces the portable kernel.
+const GemmLayout& native_gemm_layout();
+
+// B packed for one layout. Owns its buffer, or points to packed data that outlives it
+// (a mapped cache file).
+class PackedMatrix {
+public:
+    PackedMatrix() = default;
+    // Packs b, k x n with row stride ldb
+    PackedMatrix(const float* b, int k, int n, int ldb, const GemmLayout& layout = native_gemm_layout());
+    // Wraps data already packed for layout, holding packed_floats(k, n, layout) floats
+    static PackedMatrix borrow(const float* data, int k, int n, const GemmLayout& layout);
+    static size_t packed_floats(int k, int n, const GemmLayout& layout);
+
+    int rows() const { return k_; }
+    int cols() const { return n_; }
+    const GemmLayout& layout() const { return layout_; }
+    const float* data() const { return owned_.empty() ? borrowed_ : owned_.data(); }
+    size_t size() const { return packed_floats(k_, n_, layout_); }
+
+private:
+    huge_vector<float> owned_;
+    const float* borrowed_ = nullptr;
+    int k_ = 0;
+    int n_ = 0;
+    GemmLayout layout_;
+};
+
+// C = A * B + beta * C, A is m x b.rows() with row stride lda, C is m x b.cols() with row stride ldc.
+// b must be packed for a layout this CPU runs, else std::invalid_argument.
+void gemm_packed(int m, const float* a, int lda, const PackedMatrix& b, float beta, float* c, int ldc);
+
+// Packed copies of the matrices (2-D float tensors) of a model file, cached on disk.
+// The cache is the weight file <model_path>.<layout key>.packed holding one packed tensor per
+// matrix, under the same name, and a stamp of the mapped model file (size and modification time).
+// If it exists and the stamp matches, it is mapped and nothing is packed; otherwise every matrix
+// is packed and the cache is written (atomically, so concurrent starts do not see partial files).
+class PackedWeightCache {
+public:
+    PackedWeightCache(const WeightFile& model, const std::string& model_path,
+                      const GemmLayout& layout = native_gemm_layout());
+
+    // Throws std::out_of_range if the model has no matrix of that name
+    const PackedMatrix& matrix(const std::string& name) const;
+    // False when the cache was missing or stale and had to be rebuilt
+    bool loaded_from_disk() const { return loaded_from_disk_; }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    bool loaded_from_disk_ = false;
+    std::unique_ptr<WeightFile> file_;
+    std::unordered_map<std::string, PackedMatrix> matrices_;
+};
@@ -7,4 +7,58 @@
 
 #pragma once
 
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
 float mean(std::vector<float> vec);
+
+// Statistics of a stream of values, fed one batch at a time without keeping the values.
+// The mean and the variance are combined per batch (Chan et al.), which stays accurate over
+// millions of values where a running sum of squares would not.
+class RunningStats {
+public:
+    void update(const float* x, size_t n);
+    void update(const std::vector<float>& x) { update(x.data(), x.size()); }
+
+    size_t count() const { return count_; }
+    double mean() const { return mean_; }
+    // Population variance, 0 before any value
+    double variance() const { return count_ ? m2_ / count_ : 0.0; }
+    // Smallest and largest value seen, 0 before any value
+    float min() const { return min_; }
+    float max() const { return max_; }
+
+private:
+    size_t count_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    float min_ = 0.0f;
+    float max_ = 0.0f;
+};
+
+// Histogram of |x| over a stream of values, with a fixed number of bins over [0, limit).
+// The first batch sets the limit to its largest magnitude; a later value beyond the limit
+// doubles it, merging the bins in pairs, so the counts are never re-estimated and the range
+// always covers every value seen.
+class StreamingHistogram {
+public:
+    // bins must be even and at least 2, else std::invalid_argument
+    explicit StreamingHistogram(int bins = 2048);
+
+    void update(const float* x, size_t n);
+    void update(const std::vector<float>& x) { update(x.data(), x.size()); }
+
+    int bins() const { return (int)counts_.size(); }
+    const std::vector<uint64_t>& counts() const { return counts_; }
+    uint64_t total() const { return total_; }
+    float limit() const { return limit_; }
+    float bin_width() const { return limit_ / counts_.size(); }
+    // Smallest magnitude t (a bin edge) such that at least percent % of the values have |x| <= t
+    float percentile(float percent) const;
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    float limit_ = 0.0f;
+};
@@ -0,0 +1,83 @@
+//
+//  quantization.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// Affine int8 quantization: real = scale * (q - zero_point), q in [-128, 127]
+struct QuantParams {
+    float scale = 1.0f;
+    int zero_point = 0;
+};
+
+inline int8_t quantize(float x, const QuantParams& params)
+{
+    int q = (int)std::lrintf(x / params.scale) + params.zero_point;
+    return (int8_t)std::min(127, std::max(-128, q));
+}
+
+inline float dequantize(int8_t q, const QuantParams& params)
+{
+    return params.scale * (float)((int)q - params.zero_point);
+}
+
+std::vector<int8_t> quantize(const std::vector<float>& x, const QuantParams& params);
+std::vector<float> dequantize(const std::vector<int8_t>& q, const QuantParams& params);
+
+struct Dense;
+
+// Int8 kernel QuantizedDense runs on this CPU: "avx512-vnni", "avx2" or "generic".
+// DLLIB_INT8_ISA=avx2 or DLLIB_INT8_ISA=generic forces a slower one.
+const char* int8_kernel();
+
+// Int8 fully connected layer for inference: y = activation(x * W + b) on quantized buffers.
+// The weights are quantized per output channel (symmetric, scale = max |W[:, o]| / 127), the
+// products are accumulated in int32, and the accumulators are requantized to the output
+// parameters with the activation fused in as the clamp: ReLU clamps at the quantized 0 and ReLU6
+// between the quantized 0 and 6, as relu6_int8 does, so no separate activation pass is needed.
+// The weights are packed for the int8 dot product instructions: with AVX-512 VNNI, vpdpbusd
+// multiplies 4 unsigned activation bytes by 4 signed weight bytes and adds them to an int32 in
+// one instruction; the activations are made unsigned by flipping their sign bit (x + 128), and
+// the 128 * sum(W[:, o]) this adds is subtracted with the bias. AVX2 computes the same sums with
+// 16-bit multiplies.
+
+class QuantizedDense {
+public:
+    // Quantizes the weights of layer, whose activation must be Identity, ReLU or ReLU6.
+    // input_params and output_params are the quantization of x and y (see the calibration).
+    QuantizedDense(const Dense& layer, const QuantParams& input_params, const QuantParams& output_params);
+
+    // input is batch x in_features, output batch x out_features
+    void forward(const int8_t* input, int8_t* output, int batch) const;
+    void forward(const std::vector<int8_t>& input, std::vector<int8_t>& output, int batch) const;
+
+    int in_features() const { return in_features_; }
+    int out_features() const { return out_features_; }
+    const QuantParams& input_params() const { return input_params_; }
+    const QuantParams& output_params() const { return output_params_; }
+    const std::vector<float>& weight_scales() const { return weight_scales_; }
+
+private:
+    int in_features_;
+    int out_features_;
+    QuantParams input_params_;
+    QuantParams output_params_;
+    // Blocks of 16 output channels, each groups x 16 x 4 bytes: the 4 consecutive inputs of
+    // group g for the 16 channels. Padded channels and inputs are 0.
+    std::vector<int8_t> packed_weights_;
+    std::vector<float> weight_scales_;
+    // Per channel: quantized bias minus (128 + input zero point) * sum of the channel's weights
+    std::vector<int32_t> offsets_;
+    // Per channel: input_scale * weight_scale / output_scale
+    std::vector<float> multipliers_;
+    int8_t lo_;
+    int8_t hi_;
+};
@@ -0,0 +1,84 @@
+//
+//  recurrent.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+
+// Recurrent cells, one time step over a batch.
+// All buffers are row-major: x is batch x input_size, h and c are batch x hidden_size.
+
+// What the LSTM forward step keeps for its backward step
+struct LSTMStepCache {
+    std::vector<float> xh;      // batch x (input_size + hidden_size), [x, h_prev]
+    std::vector<float> gates;   // batch x 4 * hidden_size, activated gates [i, f, g, o]
+    std::vector<float> c_prev;  // batch x hidden_size
+    std::vector<float> tanh_c;  // batch x hidden_size
+};
+
+// LSTM cell
+//  [i, f, g, o] = [x, h_prev] * W + b          (one GEMM, W is (input_size + hidden_size) x 4 * hidden_size)
+//  i, f, o = sigmoid(.), g = tanh(.)
+//  c = f * c_prev + i * g
+//  h = o * tanh(c)
+class LSTMCell {
+public:
+    LSTMCell(int input_size, int hidden_size, unsigned seed = 42);
+
+    // cache may be null for inference
+    void forward(const std::vector<float>& x, const std::vector<float>& h_prev, const std::vector<float>& c_prev,
+                 std::vector<float>& h, std::vector<float>& c, int batch, LSTMStepCache* cache = nullptr) const;
+    // On entry grad_h and grad_c hold dL/dh and dL/dc of this step, on exit dL/dh_prev and dL/dc_prev.
+    // Parameter gradients are accumulated, grad_x receives dL/dx.
+    void backward(const LSTMStepCache& cache, std::vector<float>& grad_h, std::vector<float>& grad_c,
+                  std::vector<float>& grad_x, int batch);
+    void zero_grad();
+
+    int input_size;
+    int hidden_size;
+    std::vector<float> weights;
+    std::vector<float> bias;
+    std::vector<float> grad_weights;
+    std::vector<float> grad_bias;
+};
+
+// What the GRU forward step keeps for its backward step
+struct GRUStepCache {
+    std::vector<float> x;       // batch x input_size
+    std::vector<float> h_prev;  // batch x hidden_size
+    std::vector<float> gates;   // batch x 3 * hidden_size, activated gates [r, z, n]
+    std::vector<float> hn;      // batch x hidden_size, h_prev * W_hn + b_hn
+};
+
+// GRU cell
+//  [xr, xz, xn] = x * W_x + b_x,  [hr, hz, hn] = h_prev * W_h + b_h
+//  r = sigmoid(xr + hr), z = sigmoid(xz + hz)
+//  n = tanh(xn + r * hn)
+//  h = (1 - z) * n + z * h_prev
+// The reset gate only scales the recurrent part of the candidate, so the input and the recurrent
+// projections are two GEMMs (each over the three gates) instead of one over [x, h_prev].
+class GRUCell {
+public:
+    GRUCell(int input_size, int hidden_size, unsigned seed = 42);
+
+    void forward(const std::vector<float>& x, const std::vector<float>& h_prev,
+                 std::vector<float>& h, int batch, GRUStepCache* cache = nullptr) const;
+    // On entry grad_h holds dL/dh of this step, on exit dL/dh_prev.
+    void backward(const GRUStepCache& cache, std::vector<float>& grad_h, std::vector<float>& grad_x, int batch);
+    void zero_grad();
+
+    int input_size;
+    int hidden_size;
+    std::vector<float> weights_x;   // input_size x 3 * hidden_size
+    std::vector<float> weights_h;   // hidden_size x 3 * hidden_size
+    std::vector<float> bias_x;
+    std::vector<float> bias_h;
+    std::vector<float> grad_weights_x;
+    std::vector<float> grad_weights_h;
+    std::vector<float> grad_bias_x;
+    std::vector<float> grad_bias_h;
+};
@@ -0,0 +1,51 @@
+//
+//  sequence.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "recurrent.h"
+
+// Variable-length sequences packed without padding.
+// The sequences are sorted by decreasing length, so the sequences still running at time step t
+// are always the first batch_sizes[t] ones, and the tokens of step t are stored contiguously:
+//  data = [step 0: batch_sizes[0] rows][step 1: batch_sizes[1] rows]...
+// Every row is feature_size floats, the number of rows is the total number of tokens.
+struct PackedSequence {
+    int feature_size = 0;
+    std::vector<float> data;
+    std::vector<int> batch_sizes;     // active sequences per time step
+    std::vector<int> sorted_indices;  // sorted position -> index in the original batch
+    std::vector<int> lengths;         // lengths in sorted order
+
+    size_t total_tokens() const { return feature_size ? data.size() / feature_size : 0; }
+};
+
+// Each sequence is length x feature_size floats, flattened.
+PackedSequence pack_sequences(const std::vector<std::vector<float>>& sequences, int feature_size);
+// Inverse of pack_sequences, in the original batch order.
+std::vector<std::vector<float>> unpack_sequences(const PackedSequence& packed);
+// Integer labels (one per token) in the packed order of layout.
+std::vector<int> pack_labels(const std::vector<std::vector<int>>& labels, const PackedSequence& layout);
+// A packed sequence with the layout of another one and a different feature size, zero filled.
+PackedSequence packed_like(const PackedSequence& layout, int feature_size);
+
+// Recurrent layers over a packed batch, starting from zero states.
+// Each time step runs the cell on the batch_sizes[t] active rows only, so the work is
+// proportional to the number of tokens, not to batch x max_length.
+// output has one hidden state row per token. Pass caches to keep what the backward pass needs.
+void lstm_forward_packed(const LSTMCell& cell, const PackedSequence& input, PackedSequence& output,
+                         std::vector<LSTMStepCache>* caches = nullptr);
+// grad_output is dL/d(output), grad_input receives dL/d(input). Cell gradients are accumulated.
+void lstm_backward_packed(LSTMCell& cell, const std::vector<LSTMStepCache>& caches,
+                          const PackedSequence& grad_output, PackedSequence& grad_input);
+
+void gru_forward_packed(const GRUCell& cell, const PackedSequence& input, PackedSequence& output,
+                        std::vector<GRUStepCache>* caches = nullptr);
+void gru_backward_packed(GRUCell& cell, const std::vector<GRUStepCache>& caches,
+                         const PackedSequence& grad_output, PackedSequence& grad_input);
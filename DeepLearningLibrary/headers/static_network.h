@@ -0,0 +1,204 @@
+//
+//  static_network.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <tuple>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include "network.h"
+#include "vector_math.h"
+
+// Fixed-size networks for tiny models, e.g. a 16 -> 32 -> 1 scoring MLP called once per request.
+// At that size the cost of Dense/MLP is the bookkeeping: heap buffers, size checks, a switch per
+// activation and a thread pool dispatch. Here the sizes and the activations are template
+// parameters, the weights live in std::array, and every loop of the forward pass has a constant
+// trip count, so the compiler unrolls and vectorizes it for these exact sizes and inlines the
+// whole pass: no allocation, no branch on a size, no call.
+//     StaticMLP<StaticDense<16, 32, Activation::ReLU>, StaticDense<32, 1, Activation::Sigmoid>> scorer;
+//     scorer.load(mlp.layers());           // weights trained with the dynamic MLP
+//     float score = scorer.forward(features)[0];
+// Inference only. The layouts match Dense, so weights copy over as is.
+
+// One element through an activation chosen at compile time.
+// Same functions as activation_forward_inplace, with the vector_math approximations for the
+// transcendental ones so they inline.
+template <Activation A>
+inline float activate(float x)
+{
+    if constexpr (A == Activation::Identity) {
+        return x;
+    } else if constexpr (A == Activation::ReLU) {
+        return x > 0.0f ? x : 0.0f;
+    } else if constexpr (A == Activation::Sigmoid) {
+        return fast_sigmoid(x);
+    } else if constexpr (A == Activation::Tanh) {
+        return fast_tanh(x);
+    } else if constexpr (A == Activation::ELU) {
+        return x > 0.0f ? x : fast_exp(x) - 1.0f;
+    } else if constexpr (A == Activation::Softplus) {
+        return x > 20.0f ? x : std::log1p(fast_exp(x));
+    } else if constexpr (A == Activation::ReLU6) {
+        float y = x > 0.0f ? x : 0.0f;
+        return y < 6.0f ? y : 6.0f;
+    } else if constexpr (A == Activation::Hardtanh) {
+        float y = x > -1.0f ? x : -1.0f;
+        return y < 1.0f ? y : 1.0f;
+    } else {
+        float y = x + 3.0f > 0.0f ? x + 3.0f : 0.0f;
+        return (y < 6.0f ? y : 6.0f) * (1.0f / 6.0f);
+    }
+}
+
+// y = activation(x * W + b), W is In x Out row-major like Dense::weights
+template <int In, int Out, Activation A = Activation::Identity>
+struct StaticDense {
+    static_assert(In > 0 && Out > 0, "Layer sizes must be positive.");
+    static constexpr int in_features = In;
+    static constexpr int out_features = Out;
+    static constexpr Activation activation = A;
+    typedef std::array<float, In> Input;
+    typedef std::array<float, Out> Output;
+
+    std::array<float, (size_t)In * Out> weights{};
+    std::array<float, Out> bias{};
+
+    StaticDense() = default;
+    explicit StaticDense(const Dense& layer) { load(layer); }
+
+    // Copy the weights of a trained Dense, which must have the same sizes and activation
+    void load(const Dense& layer)
+    {
+        if (layer.in_features != In || layer.out_features != Out) {
+            throw std::invalid_argument("Dense layer sizes do not match the static layer.");
+        }
+        if (layer.activation != A) {
+            throw std::invalid_argument("Dense layer activation does not match the static layer.");
+        }
+        std::copy(layer.weights.begin(), layer.weights.end(), weights.begin());
+        std::copy(layer.bias.begin(), layer.bias.end(), bias.begin());
+    }
+
+    void forward(const float* x, float* y) const
+    {
+        // Each output is summed in Lanes independent partial sums over the inputs. A wide layer
+        // already has Out independent sums, a narrow one (a scoring head with one output) would
+        // otherwise be a single chain of In dependent adds.
+        constexpr int Lanes = Out < 4 ? 8 : 1;
+        float z[Lanes][Out] = {};
+        for (int i = 0; i < In; i += Lanes) {
+            for (int l = 0; l < Lanes && i + l < In; ++l) {
+                const float xi = x[i + l];
+                const float* w = &weights[(size_t)(i + l) * Out];
+                for (int o = 0; o < Out; ++o) {
+                    z[l][o] += xi * w[o];
+                }
+            }
+        }
+        for (int o = 0; o < Out; ++o) {
+            float sum = bias[o];
+            for (int l = 0; l < Lanes; ++l) {
+                sum += z[l][o];
+            }
+            y[o] = activate<A>(sum);
+        }
+    }
+
+    Output forward(const Input& x) const
+    {
+        Output y;
+        forward(x.data(), y.data());
+        return y;
+    }
+};
+
+// Stack of StaticDense layers. The intermediates are std::arrays on the stack.
+template <typename... Layers>
+class StaticMLP {
+    static_assert(sizeof...(Layers) > 0, "A network needs at least one layer.");
+    typedef std::tuple<Layers...> LayerTuple;
+    static constexpr size_t L = sizeof...(Layers);
+
+    template <size_t I>
+    static constexpr bool chained()
+    {
+        if constexpr (I + 1 >= L) {
+            return true;
+        } else {
+            return std::tuple_element_t<I, LayerTuple>::out_features == std::tuple_element_t<I + 1, LayerTuple>::in_features &&
+                   chained<I + 1>();
+        }
+    }
+    static_assert(chained<0>(), "The output size of each layer must be the input size of the next.");
+
+public:
+    static constexpr int in_features = std::tuple_element_t<0, LayerTuple>::in_features;
+    static constexpr int out_features = std::tuple_element_t<L - 1, LayerTuple>::out_features;
+    typedef std::array<float, in_features> Input;
+    typedef std::array<float, out_features> Output;
+
+    StaticMLP() = default;
+    explicit StaticMLP(const std::vector<Dense>& layers) { load(layers); }
+
+    // Copy the weights of the layers of a trained MLP, see StaticDense::load
+    void load(const std::vector<Dense>& layers)
+    {
+        if (layers.size() != L) {
+            throw std::invalid_argument("The number of layers does not match the static network.");
+        }
+        load_from<0>(layers);
+    }
+
+    template <size_t I>
+    std::tuple_element_t<I, LayerTuple>& layer() { return std::get<I>(layers_); }
+    template <size_t I>
+    const std::tuple_element_t<I, LayerTuple>& layer() const { return std::get<I>(layers_); }
+
+    Output forward(const Input& x) const
+    {
+        Output y;
+        forward_from<0>(x.data(), y.data());
+        return y;
+    }
+
+    // Rows of in_features at x to rows of out_features at y
+    void forward(const float* x, float* y, int batch = 1) const
+    {
+        for (int b = 0; b < batch; ++b) {
+            forward_from<0>(x + (size_t)b * in_features, y + (size_t)b * out_features);
+        }
+    }
+
+private:
+    template <size_t I>
+    void load_from(const std::vector<Dense>& layers)
+    {
+        std::get<I>(layers_).load(layers[I]);
+        if constexpr (I + 1 < L) {
+            load_from<I + 1>(layers);
+        }
+    }
+
+    template <size_t I>
+    void forward_from(const float* x, float* y) const
+    {
+        const auto& layer = std::get<I>(layers_);
+        if constexpr (I + 1 == L) {
+            layer.forward(x, y);
+        } else {
+            float h[std::tuple_element_t<I, LayerTuple>::out_features];
+            layer.forward(x, h);
+            forward_from<I + 1>(h, y);
+        }
+    }
+
+    LayerTuple layers_;
+};
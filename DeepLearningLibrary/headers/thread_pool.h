@@ -0,0 +1,102 @@
+//
+//  thread_pool.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Process-wide execution backend of the library.
+// One pool of worker threads is shared by every parallel kernel; each worker owns a work-stealing
+// deque and idle workers steal from the others, so uneven chunks still balance.
+
+// What idle workers do between two parallel_for calls
+enum class WaitPolicy {
+    // Sleep on a condition variable right away. Costs no CPU while idle, but every parallel_for
+    // pays for waking the workers up, which is more than small kernels take to run.
+    Passive,
+    // Spin for spin_microseconds after the last chunk before sleeping, so back-to-back small
+    // calls (batch-size-1 inference) find the workers awake. Burns one core per worker meanwhile.
+    Latency,
+};
+
+struct ThreadPoolConfig {
+    // Total threads working on a parallel_for, the calling thread included.
+    // 0 uses the DLLIB_NUM_THREADS environment variable, or else every hardware thread.
+    int num_threads = 0;
+    // Pin worker i to cpus[i % cpus.size()]. If cpus is empty, the workers fill the CPUs of
+    // NUMA node 0 first, then node 1 and so on, so neighbouring ranges of a parallel_for stay on
+    // one node (see numa.h). Linux only.
+    bool pin_threads = false;
+    std::vector<int> cpus;
+    // Passive unless the DLLIB_WAIT_POLICY environment variable is "latency"
+    WaitPolicy wait_policy = default_wait_policy();
+    int spin_microseconds = 100;
+
+    static WaitPolicy default_wait_policy();
+};
+
+// Restart the pool with a new configuration. Must not be called from inside a parallel_for.
+// parallel_for calls already running on other threads finish on the previous pool.
+void configure_thread_pool(const ThreadPoolConfig& config);
+int num_threads();
+// CPU that pool thread i (0 <= i < num_threads()) is pinned to, -1 if it is not pinned.
+// The last thread is the one calling parallel_for and is never pinned.
+int pool_thread_cpu(int thread);
+
+// Elementwise kernels split their buffers in chunks of at least this many elements,
+// smaller buffers are processed inline by the caller.
+const size_t ELEMENTWISE_GRAIN = 16384;
+
+// Below this many chunks a parallel_for only wakes sleeping workers if some are already awake
+// (spinning in latency mode, or busy); otherwise the caller runs the chunks itself.
+const size_t MIN_CHUNKS_TO_WAKE = 4;
+
+// Non-owning reference to a callable void(size_t chunk_begin, size_t chunk_end). Unlike
+// std::function it never allocates, so parallel kernels can run in steady-state inference
+// without touching the heap. The callable must outlive the call it is passed to.
+class ChunkBody {
+public:
+    template <typename F>
+    ChunkBody(const F& f)
+        : object_(&f), call_([](const void* object, size_t begin, size_t end) { (*static_cast<const F*>(object))(begin, end); })
+    {
+    }
+    void operator()(size_t begin, size_t end) const { call_(object_, begin, end); }
+
+private:
+    const void* object_;
+    void (*call_)(const void*, size_t, size_t);
+};
+
+// Calls body(chunk_begin, chunk_end) on consecutive chunks of [begin, end) of grain elements
+// (the last one may be shorter), in parallel. Returns when every chunk has run; the first
+// exception thrown by body is rethrown here. Nested calls, single chunks and calls too small to
+// be worth waking the workers (see MIN_CHUNKS_TO_WAKE) run serially on the calling thread.
+void parallel_for(size_t begin, size_t end, size_t grain, ChunkBody body);
+
+// Reduction over [begin, end): map(chunk_begin, chunk_end) gives the partial result of a chunk
+// and the partials are combined in chunk order, so the result does not depend on which thread
+// ran which chunk.
+template <typename T, typename Map, typename Combine>
+T parallel_reduce(size_t begin, size_t end, size_t grain, T identity, Map map, Combine combine)
+{
+    if (end <= begin) {
+        return identity;
+    }
+    grain = grain ? grain : 1;
+    size_t chunks = (end - begin + grain - 1) / grain;
+    std::vector<T> partial(chunks, identity);
+    parallel_for(begin, end, grain, [&](size_t chunk_begin, size_t chunk_end) {
+        partial[(chunk_begin - begin) / grain] = map(chunk_begin, chunk_end);
+    });
+    T result = identity;
+    for (const T& value : partial) {
+        result = combine(result, value);
+    }
+    return result;
+}
@@ -0,0 +1,117 @@
+//
+//  vector_math.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Branch-free float approximations of the transcendental functions used by the activations.
+// std::exp and std::tanh are calls into libm that the compiler cannot vectorize, these only use
+// multiplies, adds and bit manipulation, so a loop calling them is vectorized like any arithmetic.
+// They are accurate to a few ulp over the float range (exp saturates below -87 and above 88).
+// The float clamps are only if-converted (and the loops vectorized) with -fno-trapping-math,
+// which the build scripts pass.
+
+// exp(x) = 2^n * exp(r), n = round(x / ln 2), |r| <= ln 2 / 2, exp(r) by a degree 6 polynomial
+inline float fast_exp(float x)
+{
+    // Both bounds are tested on the original x. Clamping in sequence lets the compiler thread the
+    // saturated paths, fold them to constants and blend those into every vector lane; the constants
+    // times the next operand (sigmoid(-88) * b) are denormals, which run ten times slower.
+    float clamped = x < 88.3762626647949f ? x : 88.3762626647949f;
+    x = x > -87.3365447504f ? clamped : -87.3365447504f;
+
+    // Round to nearest by adding 1.5 * 2^23, the integer ends up in the low mantissa bits
+    const float shifter = 12582912.0f;
+    float t = x * 1.44269504088896341f + shifter;
+    float n = t - shifter;
+    int32_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    int32_t exponent = (bits - 0x4B400000) + 127;
+
+    // Cody-Waite reduction with ln 2 split in two parts
+    float r = x - n * 0.693359375f;
+    r = r + n * 2.12194440e-4f;
+
+    float p = 1.9875691500E-4f;
+    p = p * r + 1.3981999507E-3f;
+    p = p * r + 8.3334519073E-3f;
+    p = p * r + 4.1665795894E-2f;
+    p = p * r + 1.6666665459E-1f;
+    p = p * r + 5.0000001201E-1f;
+    p = p * r * r + r + 1.0f;
+
+    int32_t scale_bits = exponent << 23;
+    float scale;
+    std::memcpy(&scale, &scale_bits, sizeof(scale));
+    return p * scale;
+}
+
+inline float fast_sigmoid(float x)
+{
+    return 1.0f / (1.0f + fast_exp(-x));
+}
+
+// tanh(x) = 1 - 2 / (exp(2x) + 1)
+inline float fast_tanh(float x)
+{
+    return 1.0f - 2.0f / (fast_exp(2.0f * x) + 1.0f);
+}
+
+// sin(x) and cos(x) together, sharing the range reduction.
+// x = j * pi/2 + r with |r| <= pi/4 (pi/2 split in three parts, exact products for |j| < 4096),
+// sin(r) and cos(r) by minimax polynomials, then the quadrant j mod 4 selects and negates them.
+// Accurate to a few ulp for |x| < 6000, which covers the pre-activations of SIREN layers
+// (omega_0 * (w.x + b) with omega_0 = 30).
+const float FAST_SINCOS_RANGE = 6000.0f;
+
+inline void fast_sincos(float x, float& sin_x, float& cos_x)
+{
+    const float shifter = 12582912.0f;
+    float t = x * 0.636619772367581343f + shifter;
+    float j = t - shifter;
+    int32_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    int32_t quadrant = bits - 0x4B400000;
+
+    float r = x - j * 1.5703125f;
+    r = r - j * 4.837512969970703125e-4f;
+    r = r - j * 7.54978995489188216e-8f;
+    float r2 = r * r;
+
+    float s = -1.9515295891E-4f;
+    s = s * r2 + 8.3321608736E-3f;
+    s = s * r2 - 1.6666654611E-1f;
+    s = s * r2 * r + r;
+
+    float c = 2.443315711809948E-5f;
+    c = c * r2 - 1.388731625493765E-3f;
+    c = c * r2 + 4.166664568298827E-2f;
+    c = c * r2 * r2 - 0.5f * r2 + 1.0f;
+
+    // Quadrants 1 and 3 swap sin and cos; sin is negative in quadrants 2 and 3, cos in 1 and 2
+    bool swap = quadrant & 1;
+    float sin_r = swap ? c : s;
+    float cos_r = swap ? s : c;
+    sin_x = (quadrant & 2) ? -sin_r : sin_r;
+    cos_x = ((quadrant + 1) & 2) ? -cos_r : cos_r;
+}
+
+inline float fast_sin(float x)
+{
+    float s, c;
+    fast_sincos(x, s, c);
+    return s;
+}
+
+inline float fast_cos(float x)
+{
+    float s, c;
+    fast_sincos(x, s, c);
+    return c;
+}
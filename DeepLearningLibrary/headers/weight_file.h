@@ -0,0 +1,113 @@
+//
+//  weight_file.h
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "network.h"
+
+// Model weight files that are used in place.
+// A file is a fixed header, a directory of named tensors (type, shape, offset, size) and the raw
+// tensor payloads, each starting on a WEIGHT_ALIGNMENT byte boundary, in the byte order of the
+// machine that wrote it. WeightFile maps the file read-only and hands out pointers into the
+// mapping: opening a 2 GB model reads the header and the directory, the payload pages are only
+// loaded when a kernel first touches them, and processes serving the same file share its pages
+// in the page cache.
+//     WeightFileWriter writer;
+//     writer.add("fc1.weight", layer.weights.data(), {256, 512});
+//     writer.write("model.dlw");
+//     WeightFile file("model.dlw");
+//     graph.dense(x, 512, file.floats("fc1.weight", {256, 512}), file.floats("fc1.bias", {512}));
+// Malformed files throw std::invalid_argument, I/O failures std::runtime_error.
+
+const size_t WEIGHT_ALIGNMENT = 64;
+const size_t WEIGHT_MAX_RANK = 4;
+const size_t WEIGHT_MAX_NAME = 63;
+
+enum class TensorType : uint32_t { Float32 = 0, Int8 = 1, Int32 = 2 };
+
+size_t tensor_type_size(TensorType type);
+
+// A tensor of a mapped file, data points into the mapping
+struct WeightTensor {
+    std::string name;
+    TensorType type;
+    std::vector<size_t> shape;
+    const void* data;
+    size_t bytes;
+
+    size_t elements() const;
+};
+
+class WeightFileWriter {
+public:
+    // The data is not copied, it must stay valid until write().
+    // Names are unique and at most WEIGHT_MAX_NAME characters, shapes have 1 to WEIGHT_MAX_RANK dims.
+    void add(const std::string& name, const float* data, const std::vector<size_t>& shape);
+    void add(const std::string& name, const int8_t* data, const std::vector<size_t>& shape);
+    void add(const std::string& name, const int32_t* data, const std::vector<size_t>& shape);
+
+    // Writes to a temporary file next to path, then renames it over path, so processes that have
+    // the previous version mapped keep reading a complete file.
+    void write(const std::string& path) const;
+
+private:
+    struct Pending {
+        std::string name;
+        TensorType type;
+        std::vector<size_t> shape;
+        const void* data;
+    };
+    void add(const std::string& name, TensorType type, const void* data, const std::vector<size_t>& shape);
+
+    std::vector<Pending> tensors_;
+};
+
+class WeightFile {
+public:
+    explicit WeightFile(const std::string& path);
+    WeightFile(WeightFile&&) noexcept;
+    WeightFile& operator=(WeightFile&&) noexcept;
+    ~WeightFile();
+
+    size_t size() const { return tensors_.size(); }
+    const WeightTensor& tensor(size_t i) const { return tensors_.at(i); }
+    bool contains(const std::string& name) const { return index_.count(name) != 0; }
+    // Throws std::out_of_range if the file has no tensor of that name
+    const WeightTensor& tensor(const std::string& name) const;
+
+    // Typed access, throws std::invalid_argument if the type or the shape differ
+    const float* floats(const std::string& name, const std::vector<size_t>& shape) const;
+    const int8_t* int8s(const std::string& name, const std::vector<size_t>& shape) const;
+    const int32_t* int32s(const std::string& name, const std::vector<size_t>& shape) const;
+
+    // Ask the kernel to start reading the whole file (madvise WILLNEED), e.g. right after opening
+    // it, so the first requests do not wait for page faults
+    void prefetch() const;
+    size_t file_bytes() const { return bytes_; }
+    // Modification time of the mapped file (fstat of the descriptor that was mapped), in ns since
+    // the epoch. Identifies the mapped version even if the path has since been renamed over.
+    int64_t modified_ns() const { return modified_ns_; }
+
+private:
+    const void* checked(const std::string& name, TensorType type, const std::vector<size_t>& shape) const;
+
+    void* mapping_ = nullptr;
+    size_t bytes_ = 0;
+    int64_t modified_ns_ = 0;
+    std::vector<WeightTensor> tensors_;
+    std::unordered_map<std::string, size_t> index_;
+};
+
+// Layers of an MLP as "layer<i>.weight" (in x out) and "layer<i>.bias" (out)
+void save_weights(const std::vector<Dense>& layers, const std::string& path);
+// Copies the tensors written by save_weights into layers of the same sizes, e.g. to resume training
+void load_weights(std::vector<Dense>& layers, const WeightFile& file);
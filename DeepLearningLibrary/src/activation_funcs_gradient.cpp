@@ -5,7 +5,10 @@
 // #include "activation_funcs_gradient.h"
 #include <cmath>
 #include <vector>
+#include <algorithm>
 #include <stdexcept>
+#include "../headers/vector_math.h"
+#include "../headers/thread_pool.h"
 #include <iostream>
 // This file contains implementations of the gradients of various activation functions used in deep learning.
 // These gradients are essential for backpropagation in neural networks, allowing the model to learn from
@@ -126,10 +129,38 @@ float gaussian_gradient(float x) {
 }
 
 // Gradient of the Sinusoidal function
-float sinusoidal_gradient(float x) {
+float sinusoid_gradient(float x) {
     return std::cos(x);
 }
 
+// Gradient of the ReLU6 function
+// 1 between 0 and 6, 0 where the output is clamped
+float relu6_gradient(float x) {
+    return (x > 0.0f && x < 6.0f) ? 1.0f : 0.0f;
+}
+
+// Gradient of the Hardtanh function
+float hardtanh_gradient(float x, float min_val = -1.0f, float max_val = 1.0f) {
+    return (x > min_val && x < max_val) ? 1.0f : 0.0f;
+}
+
+// Gradient of the Hardsigmoid function
+// 1/6 on the linear part (-3, 3), 0 elsewhere
+float hardsigmoid_gradient(float x) {
+    return (x > -3.0f && x < 3.0f) ? 1.0f / 6.0f : 0.0f;
+}
+
+// Gradient of the Hardswish function
+// 0 for x <= -3, 1 for x >= 3, (2x + 3) / 6 in between
+float hardswish_gradient(float x) {
+    if (x <= -3.0f) {
+        return 0.0f;
+    } else if (x >= 3.0f) {
+        return 1.0f;
+    }
+    return (2.0f * x + 3.0f) / 6.0f;
+}
+
 // Gradient of the Softmax function
 // The gradient of the softmax function is more complex and typically requires the Jacobian matrix.
 // For simplicity, we will return a placeholder value here.
@@ -156,4 +187,228 @@ std::vector<std::vector<float>> softmax_gradient(const std::vector<float>& logit
         }
     }
     return jacobian;
-}   
\ No newline at end of file
+}
+
+// Gradients from the output
+// For these activations the derivative can be written as a function of y = f(x):
+//  - ReLU:     f'(x) = 1 if y > 0, 0 otherwise
+//  - Sigmoid:  f'(x) = y * (1 - y)
+//  - Tanh:     f'(x) = 1 - y^2
+//  - ELU:      f'(x) = 1 if y > 0, y + alpha otherwise (since alpha * exp(x) = y + alpha)
+//  - Softplus: f'(x) = sigmoid(x) = 1 - exp(-y)
+// so the forward pass does not have to be recomputed, and the input does not have to be kept.
+
+float relu_gradient_from_output(float y) {
+    return (y > 0) ? 1.0f : 0.0f;
+}
+
+float sigmoid_gradient_from_output(float y) {
+    return y * (1.0f - y);
+}
+
+float tanh_gradient_from_output(float y) {
+    return 1.0f - y * y;
+}
+
+float elu_gradient_from_output(float y, float alpha) {
+    return (y > 0) ? 1.0f : y + alpha;
+}
+
+float softplus_gradient_from_output(float y) {
+    return -std::expm1(-y); // 1 - exp(-y), accurate when y is close to 0
+}
+
+// Check that the output and the upstream gradient describe the same buffer
+static void check_backward_sizes(const std::vector<float>& output, const std::vector<float>& grad) {
+    if (output.size() != grad.size()) {
+        throw std::invalid_argument("Output and gradient must have the same size.");
+    }
+}
+
+void relu_backward_inplace(const std::vector<float>& output, std::vector<float>& grad) {
+    check_backward_sizes(output, grad);
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            grad[i] = output[i] > 0.0f ? grad[i] : 0.0f;
+        }
+    });
+}
+
+void sigmoid_backward_inplace(const std::vector<float>& output, std::vector<float>& grad) {
+    check_backward_sizes(output, grad);
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            grad[i] *= output[i] * (1.0f - output[i]);
+        }
+    });
+}
+
+void tanh_backward_inplace(const std::vector<float>& output, std::vector<float>& grad) {
+    check_backward_sizes(output, grad);
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            grad[i] *= 1.0f - output[i] * output[i];
+        }
+    });
+}
+
+void elu_backward_inplace(const std::vector<float>& output, std::vector<float>& grad, float alpha) {
+    check_backward_sizes(output, grad);
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            grad[i] *= output[i] > 0.0f ? 1.0f : output[i] + alpha;
+        }
+    });
+}
+
+void softplus_backward_inplace(const std::vector<float>& output, std::vector<float>& grad) {
+    check_backward_sizes(output, grad);
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            grad[i] *= -std::expm1(-output[i]);
+        }
+    });
+}
+
+// Hard activations over a buffer
+// ReLU6, Hardtanh and Hardsigmoid are flat where they clamp, so the gradient is known from the
+// output (it is zero exactly where the output sits on a bound). Hardswish needs its input.
+
+void relu6_backward_inplace(const std::vector<float>& output, std::vector<float>& grad) {
+    check_backward_sizes(output, grad);
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            grad[i] = (output[i] > 0.0f && output[i] < 6.0f) ? grad[i] : 0.0f;
+        }
+    });
+}
+
+void hardtanh_backward_inplace(const std::vector<float>& output, std::vector<float>& grad,
+                               float min_val, float max_val) {
+    check_backward_sizes(output, grad);
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            grad[i] = (output[i] > min_val && output[i] < max_val) ? grad[i] : 0.0f;
+        }
+    });
+}
+
+void hardsigmoid_backward_inplace(const std::vector<float>& output, std::vector<float>& grad) {
+    check_backward_sizes(output, grad);
+    const float sixth = 1.0f / 6.0f;
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            grad[i] = (output[i] > 0.0f && output[i] < 1.0f) ? grad[i] * sixth : 0.0f;
+        }
+    });
+}
+
+// The slope is selected, not branched on, so the loop still vectorizes
+void hardswish_backward_inplace(const std::vector<float>& input, std::vector<float>& grad) {
+    check_backward_sizes(input, grad);
+    const float sixth = 1.0f / 6.0f;
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float x = input[i];
+            float slope = (2.0f * x + 3.0f) * sixth;
+            slope = x <= -3.0f ? 0.0f : slope;
+            slope = x >= 3.0f ? 1.0f : slope;
+            grad[i] *= slope;
+        }
+    });
+}
+
+// Sinusoid over a buffer: dL/dx = g * cos(x)
+// fast_cos shares the range reduction of fast_sincos, so it vectorizes unlike std::cos.
+void sinusoid_backward_inplace(const std::vector<float>& input, std::vector<float>& grad) {
+    check_backward_sizes(input, grad);
+    parallel_for(0, grad.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            grad[i] *= fast_cos(input[i]);
+        }
+    });
+}
+
+// Gradients of the gated activations
+// For out = f(a) * b: dL/da = g * b * f'(a) and dL/db = g * f(a), both halves in the same pass.
+
+static int gated_backward_width(const std::vector<float>& input, const std::vector<float>& grad_output, int rows) {
+    if (rows <= 0 || input.size() % (2 * (size_t)rows) != 0) {
+        throw std::invalid_argument("Gated activation input must be rows x 2n.");
+    }
+    if (grad_output.size() * 2 != input.size()) {
+        throw std::invalid_argument("Gradient must be rows x n.");
+    }
+    return (int)(input.size() / (2 * (size_t)rows));
+}
+
+// GLU: f(a) = sigmoid(a), f'(a) = s * (1 - s)
+void glu_backward(const std::vector<float>& input, const std::vector<float>& grad_output,
+                  std::vector<float>& grad_input, int rows) {
+    int n = gated_backward_width(input, grad_output, rows);
+    grad_input.resize(input.size());
+    size_t row_grain = std::max<size_t>(1, ELEMENTWISE_GRAIN / std::max(n, 1));
+    parallel_for(0, rows, row_grain, [&](size_t row_begin, size_t row_end) {
+        for (size_t r = row_begin; r < row_end; ++r) {
+            const float* a = input.data() + r * 2 * n;
+            const float* b = a + n;
+            const float* g = grad_output.data() + r * n;
+            float* da = grad_input.data() + r * 2 * n;
+            float* db = da + n;
+            for (int j = 0; j < n; ++j) {
+                float s = fast_sigmoid(a[j]);
+                da[j] = g[j] * b[j] * s * (1.0f - s);
+                db[j] = g[j] * s;
+            }
+        }
+    });
+}
+
+// SwiGLU: f(a) = a * s, f'(a) = s + a * s * (1 - s)
+void swiglu_backward(const std::vector<float>& input, const std::vector<float>& grad_output,
+                     std::vector<float>& grad_input, int rows) {
+    int n = gated_backward_width(input, grad_output, rows);
+    grad_input.resize(input.size());
+    size_t row_grain = std::max<size_t>(1, ELEMENTWISE_GRAIN / std::max(n, 1));
+    parallel_for(0, rows, row_grain, [&](size_t row_begin, size_t row_end) {
+        for (size_t r = row_begin; r < row_end; ++r) {
+            const float* a = input.data() + r * 2 * n;
+            const float* b = a + n;
+            const float* g = grad_output.data() + r * n;
+            float* da = grad_input.data() + r * 2 * n;
+            float* db = da + n;
+            for (int j = 0; j < n; ++j) {
+                float s = fast_sigmoid(a[j]);
+                da[j] = g[j] * b[j] * (s + a[j] * s * (1.0f - s));
+                db[j] = g[j] * a[j] * s;
+            }
+        }
+    });
+}
+
+// GeGLU: f(a) = 0.5 * a * (1 + t), t = tanh(k * (a + 0.044715 * a^3)), k = sqrt(2 / pi)
+// f'(a) = 0.5 * (1 + t) + 0.5 * a * (1 - t^2) * k * (1 + 0.134145 * a^2), as in gelu_gradient()
+void geglu_backward(const std::vector<float>& input, const std::vector<float>& grad_output,
+                    std::vector<float>& grad_input, int rows) {
+    int n = gated_backward_width(input, grad_output, rows);
+    grad_input.resize(input.size());
+    const float k = std::sqrt(2.0f / float(M_PI));
+    size_t row_grain = std::max<size_t>(1, ELEMENTWISE_GRAIN / std::max(n, 1));
+    parallel_for(0, rows, row_grain, [&](size_t row_begin, size_t row_end) {
+        for (size_t r = row_begin; r < row_end; ++r) {
+            const float* a = input.data() + r * 2 * n;
+            const float* b = a + n;
+            const float* g = grad_output.data() + r * n;
+            float* da = grad_input.data() + r * 2 * n;
+            float* db = da + n;
+            for (int j = 0; j < n; ++j) {
+                float x = a[j];
+                float t = fast_tanh(k * (x + 0.044715f * x * x * x));
+                float f = 0.5f * x * (1.0f + t);
+                float df = 0.5f * (1.0f + t) + 0.5f * x * (1.0f - t * t) * k * (1.0f + 0.134145f * x * x);
+                da[j] = g[j] * b[j] * df;
+                db[j] = g[j] * f;
+            }
+        }
+    });
+}
@@ -23,11 +23,19 @@
 //  - GELU (Gaussian Error Linear Unit)
 //  - Gaussian
 //  - Sinusoidal
+//  - ReLU6, Hardtanh, Hardsigmoid, Hardswish (piecewise linear, for quantized and mobile models)
 //  These functions are implemented as standalone functions that take a single float input and return a float output.
 //  The functions are designed to be efficient and easy to use in deep learning applications.
 //  The code is written in C++ and uses the standard library for mathematical operations.
 //  The functions can be used in various deep learning frameworks and libraries, such as TensorFlow 
 #include <iostream>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "../headers/vector_math.h"
+#include "../headers/quantization.h"
+#include "../headers/thread_pool.h"
 
 #ifndef M_PI
 #define M_PI  3.14159265358979323846 // Define M_PI if not already defined
@@ -152,4 +160,314 @@ float gaussian(float x) {
 // Output range: (-1, 1)
 float sinusoid(float x) {
     return std::sin(x);
-}
\ No newline at end of file
+}
+
+// Hard activations
+// Piecewise linear replacements of the exp based activations, as used by MobileNetV3.
+// They only need compares, adds and multiplies, which is cheap in float and exact in int8.
+
+// ReLU6: A(x) = min(max(0, x), 6)
+// Output range: [0, 6]
+float relu6(float x) {
+    return std::min(std::max(x, 0.0f), 6.0f);
+}
+
+// Hardtanh: A(x) = min(max(min_val, x), max_val)
+// Output range: [min_val, max_val], [-1, 1] by default
+float hardtanh(float x, float min_val, float max_val) {
+    return std::min(std::max(x, min_val), max_val);
+}
+
+// Hardsigmoid: A(x) = relu6(x + 3) / 6, a piecewise linear sigmoid
+// Output range: [0, 1]
+float hardsigmoid(float x) {
+    return relu6(x + 3.0f) / 6.0f;
+}
+
+// Hardswish: A(x) = x * relu6(x + 3) / 6, a piecewise version of swish
+// Output range: [-0.375, inf)
+float hardswish(float x) {
+    return x * relu6(x + 3.0f) / 6.0f;
+}
+
+// In-place activations
+// These overwrite the input buffer with the activation output, so a training graph only has to keep
+// one buffer per layer. The backward pass then recovers the local derivative from the output alone
+// (see the *_from_output gradients in activation_funcs_gradient.cpp), which is only possible for
+// activations that are invertible or whose derivative is a function of the output:
+// ReLU, Sigmoid, Tanh, ELU and Softplus.
+
+// relu in place: x = max(0, x)
+void relu_inplace(float* x, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = x[i] > 0.0f ? x[i] : 0.0f;
+        }
+    });
+}
+
+// sigmoid in place: x = 1 / (1 + exp(-x))
+void sigmoid_inplace(float* x, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = 1.0f / (1.0f + std::exp(-x[i]));
+        }
+    });
+}
+
+// tanh in place: x = tanh(x)
+void tanh_inplace(float* x, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = std::tanh(x[i]);
+        }
+    });
+}
+
+// elu in place: x = x if x > 0, alpha * (exp(x) - 1) otherwise
+void elu_inplace(float* x, size_t n, float alpha) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = x[i] > 0.0f ? x[i] : alpha * (std::exp(x[i]) - 1.0f);
+        }
+    });
+}
+
+// softplus in place: x = ln(1 + exp(x))
+// log1p keeps precision for very negative inputs, and for large inputs softplus(x) == x in float.
+void softplus_inplace(float* x, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = x[i] > 20.0f ? x[i] : std::log1p(std::exp(x[i]));
+        }
+    });
+}
+
+// Gated activations
+// A gated FFN projects to 2n features and multiplies an activated half by the other half.
+// Doing it as split -> activation -> multiply writes and reads three temporaries of rows x n;
+// these read both halves of the projection row and write the gated product directly.
+// They use the approximations of vector_math.h so each loop vectorizes.
+
+// Number of output features of a gated activation, after checking the input is rows x 2n
+static int gated_width(const std::vector<float>& input, int rows) {
+    if (rows <= 0 || input.size() % (2 * (size_t)rows) != 0) {
+        throw std::invalid_argument("Gated activation input must be rows x 2n.");
+    }
+    return (int)(input.size() / (2 * (size_t)rows));
+}
+
+// GLU: A(a, b) = sigmoid(a) * b
+void glu(const std::vector<float>& input, std::vector<float>& output, int rows) {
+    int n = gated_width(input, rows);
+    output.resize((size_t)rows * n);
+    size_t row_grain = std::max<size_t>(1, ELEMENTWISE_GRAIN / std::max(n, 1));
+    parallel_for(0, rows, row_grain, [&](size_t row_begin, size_t row_end) {
+        for (size_t r = row_begin; r < row_end; ++r) {
+            const float* a = input.data() + r * 2 * n;
+            const float* b = a + n;
+            float* y = output.data() + r * n;
+            for (int j = 0; j < n; ++j) {
+                y[j] = fast_sigmoid(a[j]) * b[j];
+            }
+        }
+    });
+}
+
+// SwiGLU: A(a, b) = a * sigmoid(a) * b
+void swiglu(const std::vector<float>& input, std::vector<float>& output, int rows) {
+    int n = gated_width(input, rows);
+    output.resize((size_t)rows * n);
+    size_t row_grain = std::max<size_t>(1, ELEMENTWISE_GRAIN / std::max(n, 1));
+    parallel_for(0, rows, row_grain, [&](size_t row_begin, size_t row_end) {
+        for (size_t r = row_begin; r < row_end; ++r) {
+            const float* a = input.data() + r * 2 * n;
+            const float* b = a + n;
+            float* y = output.data() + r * n;
+            for (int j = 0; j < n; ++j) {
+                y[j] = a[j] * fast_sigmoid(a[j]) * b[j];
+            }
+        }
+    });
+}
+
+// GeGLU: A(a, b) = gelu(a) * b, with the same tanh approximation as gelu()
+void geglu(const std::vector<float>& input, std::vector<float>& output, int rows) {
+    int n = gated_width(input, rows);
+    output.resize((size_t)rows * n);
+    const float k = std::sqrt(2.0f / float(M_PI));
+    size_t row_grain = std::max<size_t>(1, ELEMENTWISE_GRAIN / std::max(n, 1));
+    parallel_for(0, rows, row_grain, [&](size_t row_begin, size_t row_end) {
+        for (size_t r = row_begin; r < row_end; ++r) {
+            const float* a = input.data() + r * 2 * n;
+            const float* b = a + n;
+            float* y = output.data() + r * n;
+            for (int j = 0; j < n; ++j) {
+                float x = a[j];
+                float t = fast_tanh(k * (x + 0.044715f * x * x * x));
+                y[j] = 0.5f * x * (1.0f + t) * b[j];
+            }
+        }
+    });
+}
+
+// Sinusoid over a buffer
+// Implicit neural representations (SIREN) apply sin to every pre-activation of every layer, so
+// std::sin, a libm call per element, dominates. fast_sin/fast_sincos (vector_math.h) reduce the
+// argument with a three-part pi/2 and evaluate short polynomials, and vectorize.
+
+// True if every value of x[begin, end) is inside the range of fast_sincos.
+// Or-ing the tests instead of breaking out keeps the check vectorized.
+static bool in_sincos_range(const float* x, size_t begin, size_t end) {
+    int outside = 0;
+    for (size_t i = begin; i < end; ++i) {
+        outside |= !(std::fabs(x[i]) < FAST_SINCOS_RANGE);
+    }
+    return outside == 0;
+}
+
+void sinusoid_inplace(float* x, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        if (!in_sincos_range(x, begin, end)) {
+            for (size_t i = begin; i < end; ++i) {
+                x[i] = std::sin(x[i]);
+            }
+            return;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = fast_sin(x[i]);
+        }
+    });
+}
+
+void sinusoid_with_gradient(const std::vector<float>& x, std::vector<float>& output, std::vector<float>& derivative) {
+    output.resize(x.size());
+    derivative.resize(x.size());
+    parallel_for(0, x.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        // x is kept, so the range is checked in the same pass and the rare chunk out of range redone
+        int outside = 0;
+        for (size_t i = begin; i < end; ++i) {
+            fast_sincos(x[i], output[i], derivative[i]);
+            outside |= !(std::fabs(x[i]) < FAST_SINCOS_RANGE);
+        }
+        if (outside) {
+            for (size_t i = begin; i < end; ++i) {
+                output[i] = std::sin(x[i]);
+                derivative[i] = std::cos(x[i]);
+            }
+        }
+    });
+}
+
+// Hard activations over a buffer, written without branches so the loops vectorize
+
+void relu6_inplace(float* x, size_t n) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = std::min(std::max(x[i], 0.0f), 6.0f);
+        }
+    });
+}
+
+void hardtanh_inplace(float* x, size_t n, float min_val, float max_val) {
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = std::min(std::max(x[i], min_val), max_val);
+        }
+    });
+}
+
+void hardsigmoid_inplace(float* x, size_t n) {
+    const float sixth = 1.0f / 6.0f;
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = std::min(std::max(x[i] + 3.0f, 0.0f), 6.0f) * sixth;
+        }
+    });
+}
+
+void hardswish_inplace(float* x, size_t n) {
+    const float sixth = 1.0f / 6.0f;
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            x[i] = x[i] * std::min(std::max(x[i] + 3.0f, 0.0f), 6.0f) * sixth;
+        }
+    });
+}
+
+// std::vector overloads of the in-place activations
+
+void relu_inplace(std::vector<float>& x) { relu_inplace(x.data(), x.size()); }
+void sigmoid_inplace(std::vector<float>& x) { sigmoid_inplace(x.data(), x.size()); }
+void tanh_inplace(std::vector<float>& x) { tanh_inplace(x.data(), x.size()); }
+void elu_inplace(std::vector<float>& x, float alpha) { elu_inplace(x.data(), x.size(), alpha); }
+void softplus_inplace(std::vector<float>& x) { softplus_inplace(x.data(), x.size()); }
+void relu6_inplace(std::vector<float>& x) { relu6_inplace(x.data(), x.size()); }
+void hardtanh_inplace(std::vector<float>& x, float min_val, float max_val) { hardtanh_inplace(x.data(), x.size(), min_val, max_val); }
+void hardsigmoid_inplace(std::vector<float>& x) { hardsigmoid_inplace(x.data(), x.size()); }
+void hardswish_inplace(std::vector<float>& x) { hardswish_inplace(x.data(), x.size()); }
+void sinusoid_inplace(std::vector<float>& x) { sinusoid_inplace(x.data(), x.size()); }
+
+// Int8 hard activations
+// An elementwise function of an int8 input only has 256 possible inputs, so it is evaluated once
+// per value into a lookup table (dequantize, apply, requantize) and the buffer is then mapped
+// through the table. ReLU6 and Hardtanh are clamps: when the input and output share their
+// quantization parameters they become an integer clamp, with no table at all.
+
+template <typename F>
+static void apply_int8_table(const std::vector<int8_t>& input, const QuantParams& input_params,
+                             std::vector<int8_t>& output, const QuantParams& output_params, F f) {
+    int8_t table[256];
+    for (int q = -128; q < 128; ++q) {
+        table[q + 128] = quantize(f(dequantize((int8_t)q, input_params)), output_params);
+    }
+    output.resize(input.size());
+    parallel_for(0, input.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            output[i] = table[input[i] + 128];
+        }
+    });
+}
+
+static bool same_params(const QuantParams& a, const QuantParams& b) {
+    return a.scale == b.scale && a.zero_point == b.zero_point;
+}
+
+static void clamp_int8(const std::vector<int8_t>& input, std::vector<int8_t>& output, int8_t lo, int8_t hi) {
+    output.resize(input.size());
+    parallel_for(0, input.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            output[i] = std::min(std::max(input[i], lo), hi);
+        }
+    });
+}
+
+void relu6_int8(const std::vector<int8_t>& input, const QuantParams& input_params,
+                std::vector<int8_t>& output, const QuantParams& output_params) {
+    if (same_params(input_params, output_params)) {
+        clamp_int8(input, output, quantize(0.0f, input_params), quantize(6.0f, input_params));
+    } else {
+        apply_int8_table(input, input_params, output, output_params, [](float x) { return relu6(x); });
+    }
+}
+
+void hardtanh_int8(const std::vector<int8_t>& input, const QuantParams& input_params,
+                   std::vector<int8_t>& output, const QuantParams& output_params,
+                   float min_val, float max_val) {
+    if (same_params(input_params, output_params)) {
+        clamp_int8(input, output, quantize(min_val, input_params), quantize(max_val, input_params));
+    } else {
+        apply_int8_table(input, input_params, output, output_params,
+                         [min_val, max_val](float x) { return hardtanh(x, min_val, max_val); });
+    }
+}
+
+void hardsigmoid_int8(const std::vector<int8_t>& input, const QuantParams& input_params,
+                      std::vector<int8_t>& output, const QuantParams& output_params) {
+    apply_int8_table(input, input_params, output, output_params, [](float x) { return hardsigmoid(x); });
+}
+
+void hardswish_int8(const std::vector<int8_t>& input, const QuantParams& input_params,
+                    std::vector<int8_t>& output, const QuantParams& output_params) {
+    apply_int8_table(input, input_params, output, output_params, [](float x) { return hardswish(x); });
+}
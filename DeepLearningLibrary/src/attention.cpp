@@ -0,0 +1,258 @@
+//
+//  attention.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Tiled scaled dot-product attention (the FlashAttention algorithm on the CPU).
+//  The queries of a head are processed in tiles of ATTN_TILE_Q rows. For each query tile the keys and
+//  values stream through in tiles of ATTN_TILE_KV rows that fit in L1/L2 together with the tile of
+//  scores, and every query row keeps a running maximum m and a running sum l of its softmax:
+//      m' = max(m, max_j s_j)
+//      l' = l * exp(m - m') + Σ_j exp(s_j - m')
+//      o' = o * exp(m - m') + Σ_j exp(s_j - m') * v_j
+//  so the output is exact at the end (o / l) while memory stays O(tile), not O(q_len * kv_len).
+//  With causal masking the key tiles entirely above the diagonal are skipped.
+//  The backward pass recomputes the scores of each tile from logsumexp = m + log(l).
+//
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "../headers/attention.h"
+#include "../headers/linalg.h"
+#include "../headers/vector_math.h"
+
+static const int ATTN_TILE_Q = 32;
+static const int ATTN_TILE_KV = 64;
+
+static float attention_scale(const AttentionConfig& config)
+{
+    return config.scale != 0.0f ? config.scale : 1.0f / std::sqrt((float)config.head_dim);
+}
+
+static void check_config(const AttentionConfig& config, const std::vector<float>& q,
+                         const std::vector<float>& k, const std::vector<float>& v)
+{
+    if (config.batch <= 0 || config.heads <= 0 || config.q_len < 0 || config.kv_len < 0 || config.head_dim <= 0) {
+        throw std::invalid_argument("Invalid attention shape.");
+    }
+    size_t bh = (size_t)config.batch * config.heads;
+    if (q.size() != bh * config.q_len * config.head_dim ||
+        k.size() != bh * config.kv_len * config.head_dim ||
+        v.size() != bh * config.kv_len * config.head_dim) {
+        throw std::invalid_argument("Attention inputs do not match the configured shape.");
+    }
+    if (config.causal && config.q_len > config.kv_len) {
+        throw std::invalid_argument("Causal attention needs at least as many keys as queries.");
+    }
+}
+
+// Last key index (exclusive) visible from query i
+static int visible_keys(const AttentionConfig& config, int i)
+{
+    return config.causal ? std::min(config.kv_len, i + (config.kv_len - config.q_len) + 1) : config.kv_len;
+}
+
+void attention_forward(const AttentionConfig& config,
+                       const std::vector<float>& q, const std::vector<float>& k, const std::vector<float>& v,
+                       std::vector<float>& out, std::vector<float>& logsumexp)
+{
+    check_config(config, q, k, v);
+    const int d = config.head_dim;
+    const float scale = attention_scale(config);
+    const float neg_inf = -std::numeric_limits<float>::infinity();
+    size_t bh = (size_t)config.batch * config.heads;
+    out.assign(bh * config.q_len * d, 0.0f);
+    logsumexp.assign(bh * config.q_len, 0.0f);
+
+    std::vector<float> scores((size_t)ATTN_TILE_Q * ATTN_TILE_KV);
+    std::vector<float> row_max(ATTN_TILE_Q), row_sum(ATTN_TILE_Q);
+
+    for (size_t h = 0; h < bh; ++h) {
+        const float* qh = q.data() + h * config.q_len * d;
+        const float* kh = k.data() + h * config.kv_len * d;
+        const float* vh = v.data() + h * config.kv_len * d;
+        float* oh = out.data() + h * config.q_len * d;
+        float* lse = logsumexp.data() + h * config.q_len;
+
+        for (int i0 = 0; i0 < config.q_len; i0 += ATTN_TILE_Q) {
+            int rows = std::min(ATTN_TILE_Q, config.q_len - i0);
+            std::fill(row_max.begin(), row_max.end(), neg_inf);
+            std::fill(row_sum.begin(), row_sum.end(), 0.0f);
+            int kv_end = visible_keys(config, i0 + rows - 1);
+
+            for (int j0 = 0; j0 < kv_end; j0 += ATTN_TILE_KV) {
+                int cols = std::min(ATTN_TILE_KV, kv_end - j0);
+                // S = Q_tile * K_tile^T * scale
+                gemm(false, true, rows, cols, d, scale, qh + (size_t)i0 * d, d, kh + (size_t)j0 * d, d,
+                     0.0f, scores.data(), cols);
+
+                for (int r = 0; r < rows; ++r) {
+                    float* s = scores.data() + (size_t)r * cols;
+                    int limit = std::max(0, std::min(cols, visible_keys(config, i0 + r) - j0));
+                    float tile_max = neg_inf;
+                    for (int c = 0; c < limit; ++c) {
+                        tile_max = std::max(tile_max, s[c]);
+                    }
+                    float new_max = std::max(row_max[r], tile_max);
+                    float correction = row_max[r] == neg_inf ? 0.0f : fast_exp(row_max[r] - new_max);
+                    float sum = 0.0f;
+                    for (int c = 0; c < limit; ++c) {
+                        s[c] = fast_exp(s[c] - new_max);
+                        sum += s[c];
+                    }
+                    // Masked keys get a probability of exactly 0
+                    std::fill(s + limit, s + cols, 0.0f);
+                    if (limit == 0) {
+                        continue;
+                    }
+                    row_sum[r] = row_sum[r] * correction + sum;
+                    row_max[r] = new_max;
+                    float* o = oh + (size_t)(i0 + r) * d;
+                    for (int x = 0; x < d; ++x) {
+                        o[x] *= correction;
+                    }
+                }
+                // O_tile += P * V_tile
+                gemm(false, false, rows, d, cols, 1.0f, scores.data(), cols, vh + (size_t)j0 * d, d,
+                     1.0f, oh + (size_t)i0 * d, d);
+            }
+
+            for (int r = 0; r < rows; ++r) {
+                float* o = oh + (size_t)(i0 + r) * d;
+                float inv = row_sum[r] > 0.0f ? 1.0f / row_sum[r] : 0.0f;
+                for (int x = 0; x < d; ++x) {
+                    o[x] *= inv;
+                }
+                lse[i0 + r] = row_sum[r] > 0.0f ? row_max[r] + std::log(row_sum[r]) : neg_inf;
+            }
+        }
+    }
+}
+
+// For every key tile, walk the query tiles that can see it:
+//  P  = exp(S - logsumexp)
+//  dV += P^T * dO
+//  dP = dO * V^T
+//  dS = P * (dP - delta), delta_i = Σ_x dO_ix * O_ix
+//  dQ += dS * K * scale, dK += dS^T * Q * scale
+void attention_backward(const AttentionConfig& config,
+                        const std::vector<float>& q, const std::vector<float>& k, const std::vector<float>& v,
+                        const std::vector<float>& out, const std::vector<float>& logsumexp,
+                        const std::vector<float>& grad_out,
+                        std::vector<float>& grad_q, std::vector<float>& grad_k, std::vector<float>& grad_v)
+{
+    check_config(config, q, k, v);
+    if (out.size() != q.size() || grad_out.size() != q.size() ||
+        logsumexp.size() != (size_t)config.batch * config.heads * config.q_len) {
+        throw std::invalid_argument("Attention outputs do not match the configured shape.");
+    }
+    const int d = config.head_dim;
+    const float scale = attention_scale(config);
+    size_t bh = (size_t)config.batch * config.heads;
+    grad_q.assign(q.size(), 0.0f);
+    grad_k.assign(k.size(), 0.0f);
+    grad_v.assign(v.size(), 0.0f);
+
+    std::vector<float> delta(config.q_len);
+    std::vector<float> probs((size_t)ATTN_TILE_Q * ATTN_TILE_KV);
+    std::vector<float> grad_probs((size_t)ATTN_TILE_Q * ATTN_TILE_KV);
+
+    for (size_t h = 0; h < bh; ++h) {
+        const float* qh = q.data() + h * config.q_len * d;
+        const float* kh = k.data() + h * config.kv_len * d;
+        const float* vh = v.data() + h * config.kv_len * d;
+        const float* oh = out.data() + h * config.q_len * d;
+        const float* doh = grad_out.data() + h * config.q_len * d;
+        const float* lse = logsumexp.data() + h * config.q_len;
+        float* dqh = grad_q.data() + h * config.q_len * d;
+        float* dkh = grad_k.data() + h * config.kv_len * d;
+        float* dvh = grad_v.data() + h * config.kv_len * d;
+
+        for (int i = 0; i < config.q_len; ++i) {
+            float sum = 0.0f;
+            for (int x = 0; x < d; ++x) {
+                sum += doh[(size_t)i * d + x] * oh[(size_t)i * d + x];
+            }
+            delta[i] = sum;
+        }
+
+        for (int j0 = 0; j0 < config.kv_len; j0 += ATTN_TILE_KV) {
+            int cols = std::min(ATTN_TILE_KV, config.kv_len - j0);
+            // First query that sees key j0
+            int i_start = config.causal ? std::max(0, j0 - (config.kv_len - config.q_len)) : 0;
+            i_start = i_start / ATTN_TILE_Q * ATTN_TILE_Q;
+
+            for (int i0 = i_start; i0 < config.q_len; i0 += ATTN_TILE_Q) {
+                int rows = std::min(ATTN_TILE_Q, config.q_len - i0);
+                gemm(false, true, rows, cols, d, scale, qh + (size_t)i0 * d, d, kh + (size_t)j0 * d, d,
+                     0.0f, probs.data(), cols);
+                for (int r = 0; r < rows; ++r) {
+                    float* p = probs.data() + (size_t)r * cols;
+                    int limit = std::max(0, std::min(cols, visible_keys(config, i0 + r) - j0));
+                    for (int c = 0; c < limit; ++c) {
+                        p[c] = fast_exp(p[c] - lse[i0 + r]);
+                    }
+                    for (int c = limit; c < cols; ++c) {
+                        p[c] = 0.0f;
+                    }
+                }
+                // dV_tile += P^T * dO_tile
+                gemm(true, false, cols, d, rows, 1.0f, probs.data(), cols, doh + (size_t)i0 * d, d,
+                     1.0f, dvh + (size_t)j0 * d, d);
+                // dP = dO_tile * V_tile^T
+                gemm(false, true, rows, cols, d, 1.0f, doh + (size_t)i0 * d, d, vh + (size_t)j0 * d, d,
+                     0.0f, grad_probs.data(), cols);
+                // dS = P * (dP - delta), stored in place of dP
+                for (int r = 0; r < rows; ++r) {
+                    const float* p = probs.data() + (size_t)r * cols;
+                    float* ds = grad_probs.data() + (size_t)r * cols;
+                    for (int c = 0; c < cols; ++c) {
+                        ds[c] = p[c] * (ds[c] - delta[i0 + r]);
+                    }
+                }
+                // dQ_tile += dS * K_tile * scale, dK_tile += dS^T * Q_tile * scale
+                gemm(false, false, rows, d, cols, scale, grad_probs.data(), cols, kh + (size_t)j0 * d, d,
+                     1.0f, dqh + (size_t)i0 * d, d);
+                gemm(true, false, cols, d, rows, scale, grad_probs.data(), cols, qh + (size_t)i0 * d, d,
+                     1.0f, dkh + (size_t)j0 * d, d);
+            }
+        }
+    }
+}
+
+std::vector<float> split_heads(const std::vector<float>& x, int batch, int len, int heads, int head_dim)
+{
+    if (x.size() != (size_t)batch * len * heads * head_dim) {
+        throw std::invalid_argument("Input size does not match batch * len * heads * head_dim.");
+    }
+    std::vector<float> y(x.size());
+    for (int b = 0; b < batch; ++b) {
+        for (int t = 0; t < len; ++t) {
+            for (int h = 0; h < heads; ++h) {
+                const float* src = x.data() + (((size_t)b * len + t) * heads + h) * head_dim;
+                float* dst = y.data() + (((size_t)b * heads + h) * len + t) * head_dim;
+                std::copy(src, src + head_dim, dst);
+            }
+        }
+    }
+    return y;
+}
+
+std::vector<float> merge_heads(const std::vector<float>& x, int batch, int len, int heads, int head_dim)
+{
+    if (x.size() != (size_t)batch * len * heads * head_dim) {
+        throw std::invalid_argument("Input size does not match batch * len * heads * head_dim.");
+    }
+    std::vector<float> y(x.size());
+    for (int b = 0; b < batch; ++b) {
+        for (int h = 0; h < heads; ++h) {
+            for (int t = 0; t < len; ++t) {
+                const float* src = x.data() + (((size_t)b * heads + h) * len + t) * head_dim;
+                float* dst = y.data() + (((size_t)b * len + t) * heads + h) * head_dim;
+                std::copy(src, src + head_dim, dst);
+            }
+        }
+    }
+    return y;
+}
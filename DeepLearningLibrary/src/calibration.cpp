@@ -0,0 +1,161 @@
+//
+//  calibration.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Choice of activation quantization parameters from calibration statistics.
+//  The entropy method follows the TensorRT calibrator: for every candidate threshold the
+//  histogram below it is merged into as many groups as there are int8 levels, each group's
+//  count spread back over its nonzero bins, and the threshold whose result diverges the least
+//  from the histogram clipped at the threshold wins.
+//
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "../headers/calibration.h"
+#include "../headers/loss_functions.h"
+
+QuantParams range_quant_params(float min, float max)
+{
+    if (!(min <= max)) {
+        throw std::invalid_argument("Range minimum must not exceed its maximum.");
+    }
+    min = std::min(min, 0.0f);
+    max = std::max(max, 0.0f);
+    QuantParams params;
+    if (max - min == 0.0f) {
+        return params;
+    }
+    params.scale = (max - min) / 255.0f;
+    params.zero_point = std::min(127, std::max(-128, -128 - (int)std::lrintf(min / params.scale)));
+    return params;
+}
+
+float entropy_threshold(const StreamingHistogram& histogram, int levels)
+{
+    if (levels < 2) {
+        throw std::invalid_argument("Entropy calibration needs at least 2 levels.");
+    }
+    const std::vector<uint64_t>& counts = histogram.counts();
+    int bins = histogram.bins();
+    if (bins <= levels || histogram.total() == 0) {
+        return histogram.limit();
+    }
+
+    std::vector<std::vector<float>> p(1), q(1);
+    double best_divergence = INFINITY;
+    int best_bins = bins;
+    uint64_t beyond = histogram.total();
+    for (int i = 0; i < levels; ++i) {
+        beyond -= counts[i];
+    }
+    for (int i = levels; i <= bins; ++i) {
+        // P: the first i bins, with the values clipped at the threshold in the last one
+        std::vector<double> clipped(counts.begin(), counts.begin() + i);
+        clipped[i - 1] += beyond;
+        if (i < bins) {
+            beyond -= counts[i];
+        }
+
+        // Q: the first i bins without the clipped values, merged into levels groups, then each
+        // group's count spread over the bins where P is nonzero. Q lacks the clipped mass, which
+        // is what makes a low threshold diverge.
+        p[0].assign(i, 0.0f);
+        q[0].assign(i, 0.0f);
+        double q_total = 0.0;
+        for (int j = 0; j < i; ++j) {
+            q_total += counts[j];
+        }
+        for (int g = 0; g < levels; ++g) {
+            int begin = (int)((long long)g * i / levels), end = (int)((long long)(g + 1) * i / levels);
+            double sum = 0.0;
+            int nonzero = 0;
+            for (int j = begin; j < end; ++j) {
+                sum += counts[j];
+                nonzero += clipped[j] != 0.0;
+            }
+            for (int j = begin; j < end; ++j) {
+                if (clipped[j] != 0.0) {
+                    p[0][j] = (float)(clipped[j] / histogram.total());
+                    // A bin with only clipped values gets a small probability instead of 0,
+                    // which would make the divergence infinite
+                    q[0][j] = sum > 0.0 ? (float)(sum / nonzero / q_total) : 1e-4f;
+                }
+            }
+        }
+        double divergence = kullback_leibler_divergence(q, p);
+        if (divergence < best_divergence) {
+            best_divergence = divergence;
+            best_bins = i;
+        }
+    }
+    return best_bins * histogram.bin_width();
+}
+
+Calibrator::Calibrator(const std::vector<Dense>& layers, int histogram_bins)
+    : layers_(&layers)
+{
+    if (layers.empty()) {
+        throw std::invalid_argument("Calibration needs at least one layer.");
+    }
+    stats_.resize(layers.size() + 1);
+    histograms_.assign(layers.size() + 1, StreamingHistogram(histogram_bins));
+}
+
+void Calibrator::observe(const std::vector<float>& input, int batch)
+{
+    const std::vector<Dense>& layers = *layers_;
+    if (batch <= 0 || input.size() != (size_t)batch * layers[0].in_features) {
+        throw std::invalid_argument("Input size does not match batch * in_features.");
+    }
+    stats_[0].update(input);
+    histograms_[0].update(input);
+    const std::vector<float>* x = &input;
+    for (size_t l = 0; l < layers.size(); ++l) {
+        std::vector<float>& y = buffers_[l % 2];
+        layers[l].forward(*x, y, batch);
+        stats_[l + 1].update(y);
+        histograms_[l + 1].update(y);
+        x = &y;
+    }
+}
+
+QuantParams Calibrator::params(size_t tensor, CalibrationMethod method, float percentile) const
+{
+    const RunningStats& s = stats_.at(tensor);
+    if (s.count() == 0) {
+        throw std::logic_error("No calibration data was observed.");
+    }
+    float min = s.min(), max = s.max();
+    float threshold = INFINITY;
+    if (method == CalibrationMethod::Percentile) {
+        threshold = histograms_[tensor].percentile(percentile);
+    } else if (method == CalibrationMethod::Entropy) {
+        // A one-sided tensor spreads the 256 levels over [0, threshold], a two-sided one has
+        // about half of them on each side
+        threshold = entropy_threshold(histograms_[tensor], min >= 0.0f ? 256 : 128);
+    }
+    return range_quant_params(std::max(min, -threshold), std::min(max, threshold));
+}
+
+std::vector<QuantParams> Calibrator::params(CalibrationMethod method, float percentile) const
+{
+    std::vector<QuantParams> result;
+    for (size_t t = 0; t < tensors(); ++t) {
+        result.push_back(params(t, method, percentile));
+    }
+    return result;
+}
+
+std::vector<QuantizedDense> quantize_layers(const std::vector<Dense>& layers, const std::vector<QuantParams>& params)
+{
+    if (params.size() != layers.size() + 1) {
+        throw std::invalid_argument("Expected one set of quantization parameters per layer plus the input.");
+    }
+    std::vector<QuantizedDense> result;
+    result.reserve(layers.size());
+    for (size_t l = 0; l < layers.size(); ++l) {
+        result.emplace_back(layers[l], params[l], params[l + 1]);
+    }
+    return result;
+}
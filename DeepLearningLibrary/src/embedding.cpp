@@ -0,0 +1,426 @@
+//
+//  embedding.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Embedding layer with sparse gradients.
+//  The forward pass gathers whole rows (one contiguous copy per id). The backward pass sorts the
+//  batch positions by id and sums the gradients of repeated ids, producing one row per unique id
+//  in ascending order; the optimizers then walk the table in increasing address order and only
+//  touch the rows that were used, instead of a dense num_embeddings x dim update.
+//
+//  Tables larger than RAM are stored in a file of raw float rows mapped with mmap. In front of the
+//  mapping sits a hot-row cache: a fixed number of row slots in RAM, replaced with the CLOCK
+//  algorithm, with an admission filter (a small count-min sketch of recent id frequencies) so that
+//  a long tail of ids seen once cannot flush the frequent ones out of the cache.
+//
+#include <cmath>
+#include <random>
+#include <numeric>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../headers/embedding.h"
+
+// Memory-mapped table with its hot-row cache
+
+static const size_t SKETCH_SIZE = 1 << 16;
+
+struct MappedTable {
+    int fd = -1;
+    float* data = nullptr;
+    size_t bytes = 0;
+    int dim = 0;
+
+    // Hot-row cache, capacity rows of dim floats
+    size_t capacity = 0;
+    std::vector<float> slots;
+    std::vector<int> slot_id;
+    std::vector<uint8_t> referenced;
+    std::vector<uint8_t> dirty;
+    std::unordered_map<int, size_t> slot_of;
+    size_t hand = 0;
+
+    // Admission filter: approximate access counts of the ids, halved periodically so it follows
+    // the recent distribution
+    std::vector<uint8_t> sketch;
+    size_t sketch_events = 0;
+
+    EmbeddingCacheStats stats;
+
+    ~MappedTable()
+    {
+        if (data) {
+            write_back_all();
+            msync(data, bytes, MS_SYNC);
+            munmap(data, bytes);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    float* mapped_row(int id) { return data + (size_t)id * dim; }
+
+    static size_t hash(int id, uint32_t seed)
+    {
+        uint32_t h = (uint32_t)id * 0x9E3779B1u ^ seed;
+        h ^= h >> 15;
+        h *= 0x85EBCA77u;
+        h ^= h >> 13;
+        return h & (SKETCH_SIZE - 1);
+    }
+
+    unsigned frequency(int id) const
+    {
+        return std::min(sketch[hash(id, 0x1234567u)], sketch[hash(id, 0x7654321u)]);
+    }
+
+    void record(int id)
+    {
+        uint8_t& a = sketch[hash(id, 0x1234567u)];
+        uint8_t& b = sketch[hash(id, 0x7654321u)];
+        if (a < 255) ++a;
+        if (b < 255) ++b;
+        if (++sketch_events >= 8 * SKETCH_SIZE) {
+            for (uint8_t& c : sketch) c >>= 1;
+            sketch_events = 0;
+        }
+    }
+
+    void write_back(size_t slot)
+    {
+        if (dirty[slot]) {
+            std::memcpy(mapped_row(slot_id[slot]), slots.data() + slot * dim, dim * sizeof(float));
+            dirty[slot] = 0;
+        }
+    }
+
+    void write_back_all()
+    {
+        for (size_t slot = 0; slot < capacity; ++slot) {
+            if (slot_id[slot] >= 0) write_back(slot);
+        }
+    }
+
+    // CLOCK: the first slot that is empty or has not been referenced since the last sweep
+    size_t find_victim()
+    {
+        while (true) {
+            size_t slot = hand;
+            hand = (hand + 1) % capacity;
+            if (slot_id[slot] < 0 || !referenced[slot]) return slot;
+            referenced[slot] = 0;
+        }
+    }
+
+    float* lookup(int id, bool write)
+    {
+        if (capacity == 0) {
+            ++stats.misses;
+            return mapped_row(id);
+        }
+        // Every access counts, hits included: a resident row that was only counted on its
+        // misses would decay to 0 with the sketch and lose its slot to any one-shot id
+        record(id);
+        auto it = slot_of.find(id);
+        if (it != slot_of.end()) {
+            ++stats.hits;
+            referenced[it->second] = 1;
+            dirty[it->second] |= write;
+            return slots.data() + it->second * dim;
+        }
+
+        ++stats.misses;
+        size_t slot = find_victim();
+        if (slot_id[slot] >= 0) {
+            // Only replace a resident row by a more frequent one
+            if (frequency(id) <= frequency(slot_id[slot])) {
+                return mapped_row(id);
+            }
+            write_back(slot);
+            slot_of.erase(slot_id[slot]);
+            ++stats.evictions;
+        }
+        std::memcpy(slots.data() + slot * dim, mapped_row(id), dim * sizeof(float));
+        slot_id[slot] = id;
+        slot_of[id] = slot;
+        referenced[slot] = 1;
+        dirty[slot] = write;
+        ++stats.admissions;
+        return slots.data() + slot * dim;
+    }
+};
+
+static std::unique_ptr<MappedTable> map_table(int fd, int num_embeddings, int dim, size_t cache_rows)
+{
+    std::unique_ptr<MappedTable> table(new MappedTable());
+    table->fd = fd;
+    table->dim = dim;
+    table->bytes = (size_t)num_embeddings * dim * sizeof(float);
+    void* addr = mmap(nullptr, table->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap the embedding table file.");
+    }
+    table->data = static_cast<float*>(addr);
+    // Lookups follow the ids of the batch, not the file order
+    madvise(addr, table->bytes, MADV_RANDOM);
+
+    table->capacity = std::min(cache_rows, (size_t)num_embeddings);
+    table->slots.resize(table->capacity * dim);
+    table->slot_id.assign(table->capacity, -1);
+    table->referenced.assign(table->capacity, 0);
+    table->dirty.assign(table->capacity, 0);
+    table->slot_of.reserve(table->capacity);
+    table->sketch.assign(SKETCH_SIZE, 0);
+    return table;
+}
+
+Embedding Embedding::create_mapped(const std::string& path, int num_embeddings, int dim,
+                                   size_t cache_rows, unsigned seed)
+{
+    if (num_embeddings <= 0 || dim <= 0) {
+        throw std::invalid_argument("Embedding sizes must be positive.");
+    }
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create the embedding table file " + path);
+    }
+    if (ftruncate(fd, (off_t)num_embeddings * dim * sizeof(float)) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to resize the embedding table file " + path);
+    }
+    std::unique_ptr<MappedTable> table = map_table(fd, num_embeddings, dim, cache_rows);
+
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    size_t count = (size_t)num_embeddings * dim;
+    for (size_t i = 0; i < count; ++i) {
+        table->data[i] = dist(gen);
+    }
+    return Embedding(num_embeddings, dim, std::move(table));
+}
+
+Embedding Embedding::open_mapped(const std::string& path, int num_embeddings, int dim, size_t cache_rows)
+{
+    if (num_embeddings <= 0 || dim <= 0) {
+        throw std::invalid_argument("Embedding sizes must be positive.");
+    }
+    int fd = open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open the embedding table file " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != (size_t)num_embeddings * dim * sizeof(float)) {
+        close(fd);
+        throw std::invalid_argument("Embedding table file size does not match num_embeddings * dim.");
+    }
+    return Embedding(num_embeddings, dim, map_table(fd, num_embeddings, dim, cache_rows));
+}
+
+Embedding::Embedding(int num_embeddings, int dim, std::unique_ptr<MappedTable> table)
+    : num_embeddings(num_embeddings), dim(dim), table_(std::move(table))
+{
+}
+
+Embedding::Embedding(Embedding&&) noexcept = default;
+Embedding& Embedding::operator=(Embedding&&) noexcept = default;
+Embedding::~Embedding() = default;
+
+float* Embedding::row(int id)
+{
+    if (table_) return table_->lookup(id, true);
+    return weights.data() + (size_t)id * dim;
+}
+
+const float* Embedding::row(int id) const
+{
+    if (table_) return table_->lookup(id, false);
+    return weights.data() + (size_t)id * dim;
+}
+
+void Embedding::prefetch(const std::vector<int>& upcoming_ids) const
+{
+    if (!table_) return;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t row_bytes = (size_t)dim * sizeof(float);
+
+    // Page ranges of the rows that are not cached, merged so each range is advised once
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.reserve(upcoming_ids.size());
+    for (int id : upcoming_ids) {
+        if (id < 0 || id >= num_embeddings) {
+            throw std::out_of_range("Embedding id is out of range.");
+        }
+        if (table_->slot_of.count(id)) continue;
+        size_t begin = (size_t)id * row_bytes;
+        size_t end = begin + row_bytes;
+        ranges.emplace_back(begin / page * page, (end + page - 1) / page * page);
+    }
+    std::sort(ranges.begin(), ranges.end());
+
+    char* base = reinterpret_cast<char*>(table_->data);
+    size_t n = 0;
+    while (n < ranges.size()) {
+        size_t begin = ranges[n].first, end = ranges[n].second;
+        while (++n < ranges.size() && ranges[n].first <= end) {
+            end = std::max(end, ranges[n].second);
+        }
+        end = std::min(end, table_->bytes);
+        madvise(base + begin, end - begin, MADV_WILLNEED);
+        table_->stats.prefetched_pages += (end - begin + page - 1) / page;
+    }
+}
+
+void Embedding::flush()
+{
+    if (!table_) return;
+    table_->write_back_all();
+    if (msync(table_->data, table_->bytes, MS_SYNC) != 0) {
+        throw std::runtime_error("Failed to sync the embedding table file.");
+    }
+}
+
+EmbeddingCacheStats Embedding::cache_stats() const
+{
+    return table_ ? table_->stats : EmbeddingCacheStats();
+}
+
+void Embedding::reset_cache_stats()
+{
+    if (table_) table_->stats = EmbeddingCacheStats();
+}
+
+// In-memory table
+
+// Elements of the table, checked in the member initializer before the weights are allocated
+static size_t checked_table_size(int num_embeddings, int dim)
+{
+    if (num_embeddings <= 0 || dim <= 0) {
+        throw std::invalid_argument("Embedding sizes must be positive.");
+    }
+    return (size_t)num_embeddings * dim;
+}
+
+Embedding::Embedding(int num_embeddings, int dim, unsigned seed)
+    : num_embeddings(num_embeddings), dim(dim), weights(checked_table_size(num_embeddings, dim))
+{
+    std::mt19937 gen(seed);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    for (float& w : weights) {
+        w = dist(gen);
+    }
+}
+
+void Embedding::forward(const std::vector<int>& ids, std::vector<float>& output) const
+{
+    output.resize(ids.size() * dim);
+    auto copy_row = [&](size_t i) {
+        if (ids[i] < 0 || ids[i] >= num_embeddings) {
+            throw std::out_of_range("Embedding id is out of range.");
+        }
+        const float* src = row(ids[i]);
+        std::copy(src, src + dim, output.begin() + i * dim);
+    };
+    if (!table_) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            copy_row(i);
+        }
+        return;
+    }
+    // In the mapped mode the rows are read in file order, so the page faults of a batch
+    // hit the file sequentially instead of jumping back and forth
+    std::vector<size_t> order(ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ids](size_t a, size_t b) { return ids[a] < ids[b]; });
+    for (size_t i : order) {
+        copy_row(i);
+    }
+}
+
+SparseGradient Embedding::backward(const std::vector<int>& ids, const std::vector<float>& grad_output) const
+{
+    if (grad_output.size() != ids.size() * dim) {
+        throw std::invalid_argument("Gradient size does not match ids.size() * dim.");
+    }
+    // Batch positions ordered by id, so equal ids are adjacent
+    std::vector<size_t> order(ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ids](size_t a, size_t b) { return ids[a] < ids[b]; });
+
+    SparseGradient grad;
+    grad.dim = dim;
+    for (size_t n = 0; n < order.size(); ++n) {
+        int id = ids[order[n]];
+        if (id < 0 || id >= num_embeddings) {
+            throw std::out_of_range("Embedding id is out of range.");
+        }
+        const float* g = grad_output.data() + order[n] * dim;
+        if (grad.indices.empty() || grad.indices.back() != id) {
+            grad.indices.push_back(id);
+            grad.values.insert(grad.values.end(), g, g + dim);
+        } else {
+            float* acc = grad.values.data() + grad.values.size() - dim;
+            for (int j = 0; j < dim; ++j) {
+                acc[j] += g[j];
+            }
+        }
+    }
+    return grad;
+}
+
+static void check_sparse_gradient(const Embedding& embedding, const SparseGradient& grad)
+{
+    if (grad.dim != embedding.dim || grad.values.size() != grad.indices.size() * (size_t)grad.dim) {
+        throw std::invalid_argument("Sparse gradient does not match the embedding table.");
+    }
+    for (int id : grad.indices) {
+        if (id < 0 || id >= embedding.num_embeddings) {
+            throw std::out_of_range("Embedding id is out of range.");
+        }
+    }
+}
+
+void sparse_sgd_update(Embedding& embedding, const SparseGradient& grad, float learning_rate)
+{
+    check_sparse_gradient(embedding, grad);
+    int dim = grad.dim;
+    for (size_t n = 0; n < grad.indices.size(); ++n) {
+        float* w = embedding.row(grad.indices[n]);
+        const float* g = grad.values.data() + n * dim;
+        for (int j = 0; j < dim; ++j) {
+            w[j] -= learning_rate * g[j];
+        }
+    }
+}
+
+SparseAdagrad::SparseAdagrad(const Embedding& embedding, float learning_rate, float epsilon)
+    : learning_rate_(learning_rate), epsilon_(epsilon),
+      accumulators_((size_t)embedding.num_embeddings * embedding.dim, 0.0f)
+{
+}
+
+// acc += g^2, w -= lr * g / (sqrt(acc) + eps), only on the rows in the gradient
+void SparseAdagrad::step(Embedding& embedding, const SparseGradient& grad)
+{
+    check_sparse_gradient(embedding, grad);
+    if (accumulators_.size() != (size_t)embedding.num_embeddings * embedding.dim) {
+        throw std::invalid_argument("Optimizer state does not match the embedding table.");
+    }
+    int dim = grad.dim;
+    for (size_t n = 0; n < grad.indices.size(); ++n) {
+        float* w = embedding.row(grad.indices[n]);
+        float* acc = accumulators_.data() + (size_t)grad.indices[n] * dim;
+        const float* g = grad.values.data() + n * dim;
+        for (int j = 0; j < dim; ++j) {
+            acc[j] += g[j] * g[j];
+            w[j] -= learning_rate_ * g[j] / (std::sqrt(acc[j]) + epsilon_);
+        }
+    }
+}
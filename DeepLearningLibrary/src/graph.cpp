@@ -0,0 +1,528 @@
+//
+//  graph.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Static inference graph with an arena planned from the tensor lifetimes.
+//  Each intermediate tensor lives from the node that produces it to the last node that reads it
+//  (the output lives to the end). Tensors that an elementwise node overwrites in place share one
+//  storage slot, whose lifetime is the union of theirs. Slots are then placed largest first, each
+//  at the lowest offset that does not overlap a slot already placed whose lifetime intersects its
+//  own; lifetimes are inclusive, since a node reads its inputs while it writes its output.
+//  Fusion: an elementwise node whose streamed input is only read by it is merged into the node
+//  producing that input, as extra steps of the producer's loop. The merged loop walks its tensor
+//  in tiles of FUSION_TILE floats and applies every step to a tile while it is in L1, so a chain
+//  of k nodes costs one pass over memory instead of k. A dense node applies its steps to each
+//  block of rows right after computing it; a loss absorbs the elementwise chain feeding it.
+//
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "../headers/graph.h"
+#include "../headers/linalg.h"
+#include "../headers/thread_pool.h"
+
+// Slots start on 64 byte boundaries
+static const size_t SLOT_ALIGNMENT_FLOATS = 16;
+// Floats per tile of a fused loop, 4 KB
+static const size_t FUSION_TILE = 1024;
+
+static size_t align_floats(size_t floats)
+{
+    return (floats + SLOT_ALIGNMENT_FLOATS - 1) / SLOT_ALIGNMENT_FLOATS * SLOT_ALIGNMENT_FLOATS;
+}
+
+InferenceGraph::InferenceGraph(int input_features)
+{
+    if (input_features <= 0) {
+        throw std::invalid_argument("Number of input features must be positive.");
+    }
+    add_tensor(input_features, -1);
+}
+
+int InferenceGraph::add_tensor(int features, int producer)
+{
+    tensors_.push_back({features, producer});
+    max_batch_ = 0;
+    return (int)tensors_.size() - 1;
+}
+
+const InferenceGraph::Tensor& InferenceGraph::tensor(int id) const
+{
+    if (id < 0 || id >= (int)tensors_.size()) {
+        throw std::out_of_range("Tensor id does not exist in the graph.");
+    }
+    return tensors_[id];
+}
+
+int InferenceGraph::dense(int x, const Dense& layer)
+{
+    Weights weights{layer.in_features, layer.out_features, layer.weights, layer.bias};
+    return add_dense(x, std::move(weights), layer.activation);
+}
+
+int InferenceGraph::dense(int x, int out_features, const float* weights, const float* bias, Activation activation)
+{
+    if (out_features <= 0) {
+        throw std::invalid_argument("Layer sizes must be positive.");
+    }
+    if (!weights || !bias) {
+        throw std::invalid_argument("Layer weights and bias must not be null.");
+    }
+    Weights borrowed{tensor(x).features, out_features};
+    borrowed.external_weights = weights;
+    borrowed.external_bias = bias;
+    return add_dense(x, std::move(borrowed), activation);
+}
+
+int InferenceGraph::dense(int x, const PackedMatrix& weights, const float* bias, Activation activation)
+{
+    if (!weights.data() || !bias) {
+        throw std::invalid_argument("Layer weights and bias must not be null.");
+    }
+    Weights borrowed{weights.rows(), weights.cols()};
+    borrowed.external_bias = bias;
+    borrowed.packed = &weights;
+    return add_dense(x, std::move(borrowed), activation);
+}
+
+int InferenceGraph::add_dense(int x, Weights weights, Activation activation)
+{
+    if (tensor(x).features != weights.in_features) {
+        throw std::invalid_argument("Tensor width does not match the layer input size.");
+    }
+    int out_features = weights.out_features;
+    layers_.push_back(std::move(weights));
+    Op op{OpKind::Dense, {x}, -1};
+    op.layer = (int)layers_.size() - 1;
+    op.output = add_tensor(out_features, (int)ops_.size());
+    ops_.push_back(op);
+    output_ = op.output;
+    return this->activation(op.output, activation);
+}
+
+int InferenceGraph::add_elementwise(int x, const Step& step, int side_input)
+{
+    Op op{OpKind::Elementwise, {x}, -1};
+    if (side_input >= 0) {
+        op.inputs.push_back(side_input);
+    }
+    op.steps.push_back(step);
+    op.output = add_tensor(tensor(x).features, (int)ops_.size());
+    ops_.push_back(op);
+    output_ = op.output;
+    return op.output;
+}
+
+int InferenceGraph::activation(int x, Activation activation)
+{
+    tensor(x);
+    if (activation == Activation::Identity) {
+        return x;
+    }
+    Step step{Step::Activate};
+    step.activation = activation;
+    return add_elementwise(x, step, -1);
+}
+
+int InferenceGraph::add(int a, int b)
+{
+    if (tensor(a).features != tensor(b).features) {
+        throw std::invalid_argument("Added tensors must have the same width.");
+    }
+    Step step{Step::AddTensor};
+    step.tensor = b;
+    return add_elementwise(a, step, b);
+}
+
+int InferenceGraph::scale_shift(int x, float scale, float shift)
+{
+    tensor(x);
+    Step step{Step::ScaleShift};
+    step.scale = scale;
+    step.shift = shift;
+    return add_elementwise(x, step, -1);
+}
+
+int InferenceGraph::targets(int features)
+{
+    if (targets_ >= 0) {
+        throw std::logic_error("The graph already has a targets input.");
+    }
+    if (features <= 0) {
+        throw std::invalid_argument("Number of target features must be positive.");
+    }
+    targets_ = add_tensor(features, -1);
+    return targets_;
+}
+
+int InferenceGraph::loss(int x, int targets, GraphLoss kind)
+{
+    if (targets != targets_ || targets < 0) {
+        throw std::invalid_argument("Loss targets must be the tensor returned by targets().");
+    }
+    if (tensor(x).features != tensor(targets).features) {
+        throw std::invalid_argument("Predictions and targets must have the same width.");
+    }
+    Op op{OpKind::Loss, {x, targets}, -1};
+    op.loss = kind;
+    op.output = add_tensor(1, (int)ops_.size());
+    ops_.push_back(op);
+    output_ = op.output;
+    return op.output;
+}
+
+void InferenceGraph::set_output(int x)
+{
+    if (tensor(x).producer < 0) {
+        throw std::invalid_argument("The graph output must be produced by a node.");
+    }
+    output_ = x;
+    max_batch_ = 0;
+}
+
+int InferenceGraph::output_features() const
+{
+    return output_ < 0 ? 0 : tensor(output_).features;
+}
+
+size_t InferenceGraph::unplanned_bytes() const
+{
+    size_t floats = 0;
+    for (const Tensor& t : tensors_) {
+        if (t.producer >= 0) {
+            floats += align_floats((size_t)t.features * max_batch_);
+        }
+    }
+    return floats * sizeof(float);
+}
+
+FusionReport InferenceGraph::fuse()
+{
+    FusionReport report;
+    report.nodes_before = (int)ops_.size();
+
+    std::vector<int> uses(tensors_.size(), 0);
+    for (const Op& op : ops_) {
+        for (int x : op.inputs) ++uses[x];
+    }
+    std::vector<bool> removed(ops_.size(), false);
+    // Position each op will run at, side inputs of a merged node must be ready by then
+    auto ready_before = [&](int t, int position) { return tensors_[t].producer < position; };
+
+    for (int b = 0; b < (int)ops_.size(); ++b) {
+        Op& consumer = ops_[b];
+        if (consumer.kind == OpKind::Dense) continue;
+        int x = consumer.inputs[0];
+        int a = tensors_[x].producer;
+        if (a < 0 || removed[a] || uses[x] != 1 || x == output_) continue;
+        Op& producer = ops_[a];
+        if (producer.kind == OpKind::Loss) continue;
+
+        if (consumer.kind == OpKind::Elementwise) {
+            bool ready = true;
+            for (size_t k = 1; k < consumer.inputs.size(); ++k) {
+                ready &= ready_before(consumer.inputs[k], a);
+            }
+            if (!ready) continue;
+            // The producer takes over the consumer's steps and output
+            producer.steps.insert(producer.steps.end(), consumer.steps.begin(), consumer.steps.end());
+            producer.inputs.insert(producer.inputs.end(), consumer.inputs.begin() + 1, consumer.inputs.end());
+            producer.output = consumer.output;
+            tensors_[consumer.output].producer = a;
+            removed[b] = true;
+        } else {
+            // A loss absorbs the steps of its producer. An elementwise producer disappears; a dense
+            // one still has to store its output, so moving its steps saves no pass, but it lets
+            // a final sigmoid meet the cross-entropy.
+            consumer.steps.insert(consumer.steps.begin(), producer.steps.begin(), producer.steps.end());
+            consumer.inputs.insert(consumer.inputs.begin() + 1, producer.inputs.begin() + 1, producer.inputs.end());
+            producer.steps.clear();
+            producer.inputs.resize(1);
+            if (producer.kind == OpKind::Dense) {
+                continue;
+            }
+            consumer.inputs[0] = producer.inputs[0];
+            removed[a] = true;
+        }
+        tensors_[x].producer = -2;
+        ++report.memory_passes_saved;
+    }
+
+    // Compact the op list and renumber the producers
+    std::vector<Op> kept;
+    for (size_t i = 0; i < ops_.size(); ++i) {
+        if (removed[i]) continue;
+        tensors_[ops_[i].output].producer = (int)kept.size();
+        kept.push_back(std::move(ops_[i]));
+    }
+    ops_ = std::move(kept);
+
+    for (const Op& op : ops_) {
+        if (op.kind == OpKind::Loss && op.loss == GraphLoss::BinaryCrossEntropy && !op.steps.empty() &&
+            op.steps.back().kind == Step::Activate && op.steps.back().activation == Activation::Sigmoid) {
+            ++report.sigmoid_cross_entropy_rewrites;
+        }
+    }
+    report.nodes_after = (int)ops_.size();
+    max_batch_ = 0;
+    return report;
+}
+
+void InferenceGraph::plan_storage()
+{
+    const int end = (int)ops_.size();
+    std::vector<int> last_use(tensors_.size(), -1);
+    for (int i = 0; i < end; ++i) {
+        for (int x : ops_[i].inputs) {
+            last_use[x] = i;
+        }
+    }
+    last_use[output_] = end;
+
+    // Slots: an elementwise node reuses the slot of an input that dies at that node
+    storage_.clear();
+    for (Tensor& t : tensors_) {
+        t.storage = -1;
+    }
+    for (int i = 0; i < end; ++i) {
+        Op& op = ops_[i];
+        Tensor& out = tensors_[op.output];
+        // Only the streamed input: the steps read the other inputs after the tile is written.
+        // After fusion a side input can be the streamed input itself (x + relu(x) merged into
+        // the node producing x), which must then survive the tile being overwritten.
+        int x = op.inputs[0];
+        bool side_input = std::find(op.inputs.begin() + 1, op.inputs.end(), x) != op.inputs.end();
+        if (op.kind == OpKind::Elementwise && tensors_[x].producer >= 0 && last_use[x] == i && !side_input) {
+            out.storage = tensors_[x].storage;
+        }
+        if (out.storage < 0) {
+            storage_.push_back({(size_t)out.features, i, i});
+            out.storage = (int)storage_.size() - 1;
+        }
+        Storage& slot = storage_[out.storage];
+        slot.last_op = std::max(slot.last_op, last_use[op.output]);
+    }
+
+    // Largest first, lowest offset that fits between the slots whose lifetimes intersect
+    std::vector<int> order(storage_.size());
+    for (size_t s = 0; s < order.size(); ++s) order[s] = (int)s;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return storage_[a].floats_per_row > storage_[b].floats_per_row;
+    });
+    auto slot_floats = [&](const Storage& s) { return align_floats(s.floats_per_row * max_batch_); };
+
+    std::vector<int> placed;
+    size_t arena_floats = 0;
+    for (int s : order) {
+        Storage& slot = storage_[s];
+        std::vector<const Storage*> live;
+        for (int p : placed) {
+            const Storage& other = storage_[p];
+            if (other.first_op <= slot.last_op && slot.first_op <= other.last_op) {
+                live.push_back(&other);
+            }
+        }
+        std::sort(live.begin(), live.end(), [](const Storage* a, const Storage* b) { return a->offset < b->offset; });
+        size_t offset = 0;
+        for (const Storage* other : live) {
+            if (offset + slot_floats(slot) <= other->offset) {
+                break;
+            }
+            offset = std::max(offset, other->offset + slot_floats(*other));
+        }
+        slot.offset = offset;
+        placed.push_back(s);
+        arena_floats = std::max(arena_floats, offset + slot_floats(slot));
+    }
+    arena_.assign(arena_floats, 0.0f);
+}
+
+void InferenceGraph::compile(int max_batch)
+{
+    if (max_batch <= 0) {
+        throw std::invalid_argument("Batch size must be positive.");
+    }
+    if (output_ < 0) {
+        throw std::logic_error("The graph has no node.");
+    }
+    max_batch_ = max_batch;
+    plan_storage();
+}
+
+float* InferenceGraph::data(int id) const
+{
+    // The external inputs are only ever read: no node writes in place over them
+    if (id == input()) {
+        return const_cast<float*>(input_data_);
+    }
+    if (id == targets_) {
+        return const_cast<float*>(targets_data_);
+    }
+    return const_cast<float*>(arena_.data()) + storage_[tensors_[id].storage].offset;
+}
+
+// Steps [first, last) over n values y, which are the elements [offset, offset + n) of the node's tensor
+void InferenceGraph::apply_steps(const Step* first, const Step* last, float* y, size_t offset, size_t n) const
+{
+    for (const Step* s = first; s != last; ++s) {
+        const Step& step = *s;
+        switch (step.kind) {
+            case Step::Activate:
+                activation_forward_inplace(step.activation, y, n);
+                break;
+            case Step::ScaleShift: {
+                // Locals, y could alias the step for all the compiler knows
+                const float scale = step.scale, shift = step.shift;
+                for (size_t i = 0; i < n; ++i) {
+                    y[i] = y[i] * scale + shift;
+                }
+                break;
+            }
+            case Step::AddTensor: {
+                const float* z = data(step.tensor) + offset;
+                for (size_t i = 0; i < n; ++i) {
+                    y[i] += z[i];
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Blocks of rows in parallel: bias, gemm on the block, then the steps tile by tile while the
+// block is still in cache
+void InferenceGraph::run_dense(const Op& op, int batch)
+{
+    const Weights& w = layers_[op.layer];
+    const float* x = data(op.inputs[0]);
+    float* y = data(op.output);
+    size_t block_rows = std::max<size_t>(1, ELEMENTWISE_GRAIN / w.out_features);
+    const float* weights = w.weight_data();
+    const float* bias = w.bias_data();
+    parallel_for(0, batch, block_rows, [&](size_t row_begin, size_t row_end) {
+        int rows = (int)(row_end - row_begin);
+        float* block = y + row_begin * w.out_features;
+        for (int r = 0; r < rows; ++r) {
+            std::copy(bias, bias + w.out_features, block + (size_t)r * w.out_features);
+        }
+        if (w.packed) {
+            gemm_packed(rows, x + row_begin * w.in_features, w.in_features, *w.packed, 1.0f, block, w.out_features);
+        } else {
+            gemm(false, false, rows, w.out_features, w.in_features,
+                 1.0f, x + row_begin * w.in_features, w.in_features, weights, w.out_features,
+                 1.0f, block, w.out_features);
+        }
+        size_t begin = row_begin * w.out_features, end = row_end * w.out_features;
+        for (size_t t = begin; t < end && !op.steps.empty(); t += FUSION_TILE) {
+            apply_steps(op.steps.data(), op.steps.data() + op.steps.size(), y + t, t, std::min(FUSION_TILE, end - t));
+        }
+    });
+}
+
+void InferenceGraph::run_elementwise(const Op& op, int batch)
+{
+    const float* x = data(op.inputs[0]);
+    float* y = data(op.output);
+    size_t n = (size_t)batch * tensors_[op.output].features;
+    parallel_for(0, n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t += FUSION_TILE) {
+            size_t len = std::min(FUSION_TILE, end - t);
+            if (x != y) {
+                std::copy(x + t, x + t + len, y + t);
+            }
+            apply_steps(op.steps.data(), op.steps.data() + op.steps.size(), y + t, t, len);
+        }
+    });
+}
+
+// log(sigmoid(z)) = -softplus(-z) and log(1 - sigmoid(z)) = -softplus(z), with
+// softplus(z) = max(z, 0) + log1p(exp(-|z|)), exact for any z where the sigmoid would round to 0 or 1
+static float sigmoid_cross_entropy(float z, float t)
+{
+    return std::max(z, 0.0f) - z * t + std::log1p(std::exp(-std::fabs(z)));
+}
+
+// One row at a time, through a tile on the stack, so the chain feeding the loss is never stored
+void InferenceGraph::run_loss(const Op& op, int batch)
+{
+    const float* x = data(op.inputs[0]);
+    const float* target = data(op.inputs.back());
+    float* y = data(op.output);
+    size_t features = tensors_[op.inputs.back()].features;
+
+    // Binary cross-entropy of a sigmoid is computed from the logits, without the last step
+    bool from_logits = op.loss == GraphLoss::BinaryCrossEntropy && !op.steps.empty() &&
+                       op.steps.back().kind == Step::Activate && op.steps.back().activation == Activation::Sigmoid;
+    const Step* steps_begin = op.steps.data();
+    const Step* steps_end = steps_begin + op.steps.size() - (from_logits ? 1 : 0);
+
+    parallel_for(0, batch, std::max<size_t>(1, ELEMENTWISE_GRAIN / features), [&](size_t row_begin, size_t row_end) {
+        float tile[FUSION_TILE];
+        for (size_t r = row_begin; r < row_end; ++r) {
+            float sum = 0.0f;
+            for (size_t c = 0; c < features; c += FUSION_TILE) {
+                size_t len = std::min(FUSION_TILE, features - c);
+                size_t offset = r * features + c;
+                std::copy(x + offset, x + offset + len, tile);
+                apply_steps(steps_begin, steps_end, tile, offset, len);
+                const float* t = target + offset;
+                switch (op.loss) {
+                    case GraphLoss::MeanSquaredError:
+                        for (size_t i = 0; i < len; ++i) sum += (tile[i] - t[i]) * (tile[i] - t[i]);
+                        break;
+                    case GraphLoss::MeanAbsoluteError:
+                        for (size_t i = 0; i < len; ++i) sum += std::fabs(tile[i] - t[i]);
+                        break;
+                    case GraphLoss::BinaryCrossEntropy:
+                        if (from_logits) {
+                            for (size_t i = 0; i < len; ++i) sum += sigmoid_cross_entropy(tile[i], t[i]);
+                        } else {
+                            for (size_t i = 0; i < len; ++i) {
+                                sum -= t[i] * std::log(tile[i]) + (1.0f - t[i]) * std::log(1.0f - tile[i]);
+                            }
+                        }
+                        break;
+                }
+            }
+            y[r] = sum / features;
+        }
+    });
+}
+
+const float* InferenceGraph::run(const float* input, const float* targets, int batch)
+{
+    if (max_batch_ == 0) {
+        throw std::logic_error("The graph must be compiled before it is run.");
+    }
+    if (batch <= 0 || batch > max_batch_) {
+        throw std::invalid_argument("Batch size must be between 1 and the compiled maximum.");
+    }
+    if (targets_ >= 0 && !targets) {
+        throw std::invalid_argument("The graph has a loss, run it with targets.");
+    }
+    input_data_ = input;
+    targets_data_ = targets;
+
+    for (const Op& op : ops_) {
+        switch (op.kind) {
+            case OpKind::Dense: run_dense(op, batch); break;
+            case OpKind::Elementwise: run_elementwise(op, batch); break;
+            case OpKind::Loss: run_loss(op, batch); break;
+        }
+    }
+    return data(output_);
+}
+
+const float* InferenceGraph::run(const float* input, int batch)
+{
+    return run(input, nullptr, batch);
+}
+
+const float* InferenceGraph::run(const std::vector<float>& input, int batch)
+{
+    if (input.size() != (size_t)batch * tensors_[0].features) {
+        throw std::invalid_argument("Input size does not match batch * input_features.");
+    }
+    return run(input.data(), batch);
+}
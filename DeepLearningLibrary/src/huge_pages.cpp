@@ -0,0 +1,104 @@
+//
+//  huge_pages.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Large buffers are anonymous mappings: mmap HUGE_PAGE_SIZE more than needed and unmap the
+//  unaligned head and tail, which leaves a 2 MB aligned mapping of whole 2 MB pages the kernel
+//  can back with huge pages. hugetlbfs mappings are 2 MB aligned by construction. Either way the
+//  mapping is bytes rounded up to HUGE_PAGE_SIZE long, so huge_page_free only needs the size.
+//
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#include "../headers/huge_pages.h"
+
+static std::atomic<HugePageMode> mode{HugePageMode::TransparentOrHugeTlb};
+
+void configure_huge_pages(HugePageMode new_mode)
+{
+    mode.store(new_mode);
+}
+
+HugePageMode huge_page_mode()
+{
+    return mode.load();
+}
+
+#if defined(__linux__)
+
+static size_t mapping_length(size_t bytes)
+{
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+// False when transparent huge pages are compiled out or set to "never"
+static bool transparent_huge_pages_available()
+{
+    static const bool available = [] {
+        std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+        std::string setting;
+        std::getline(file, setting);
+        return file && setting.find("[never]") == std::string::npos;
+    }();
+    return available;
+}
+
+void* huge_page_alloc(size_t bytes, PageKind* kind)
+{
+    size_t length = mapping_length(bytes);
+    HugePageMode current = mode.load();
+
+    if (current == HugePageMode::TransparentOrHugeTlb && !transparent_huge_pages_available()) {
+        void* data = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (data != MAP_FAILED) {
+            if (kind) *kind = PageKind::HugeTlb;
+            return data;
+        }
+        // No hugetlbfs pages reserved, fall through to regular pages
+    }
+
+    void* raw = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    uintptr_t begin = (uintptr_t)raw;
+    uintptr_t aligned = (begin + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    if (aligned > begin) {
+        munmap(raw, aligned - begin);
+    }
+    size_t tail = begin + length + HUGE_PAGE_SIZE - (aligned + length);
+    if (tail > 0) {
+        munmap((void*)(aligned + length), tail);
+    }
+
+    bool advised = current != HugePageMode::Off && madvise((void*)aligned, length, MADV_HUGEPAGE) == 0;
+    if (kind) *kind = advised ? PageKind::Transparent : PageKind::Regular;
+    return (void*)aligned;
+}
+
+void huge_page_free(void* data, size_t bytes)
+{
+    if (data) {
+        munmap(data, mapping_length(bytes));
+    }
+}
+
+#else
+
+void* huge_page_alloc(size_t bytes, PageKind* kind)
+{
+    if (kind) *kind = PageKind::Regular;
+    return ::operator new(bytes);
+}
+
+void huge_page_free(void* data, size_t)
+{
+    ::operator delete(data);
+}
+
+#endif
@@ -0,0 +1,187 @@
+//
+//  kv_cache.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Paged key/value cache and the decode-step attention kernel.
+//  Decoding one token against a prefix of n tokens only needs the n cached keys and values: the
+//  kernel walks the pages of the sequence and, for each head, scores a contiguous block of keys,
+//  then folds the block into the output with the same online softmax as attention.cpp.
+//
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "../headers/kv_cache.h"
+#include "../headers/vector_math.h"
+
+KVCache::KVCache(int heads, int head_dim, int max_tokens, int page_size)
+    : heads_(heads), head_dim_(head_dim), page_size_(page_size)
+{
+    if (heads <= 0 || head_dim <= 0 || max_tokens <= 0 || page_size <= 0) {
+        throw std::invalid_argument("KV cache sizes must be positive.");
+    }
+    int num_pages = (max_tokens + page_size - 1) / page_size;
+    size_t page_floats = (size_t)heads * page_size * head_dim;
+    keys_.assign(num_pages * page_floats, 0.0f);
+    values_.assign(num_pages * page_floats, 0.0f);
+    // Hand out the low pages first
+    for (int p = num_pages - 1; p >= 0; --p) {
+        free_pages_.push_back(p);
+    }
+}
+
+int KVCache::add_sequence()
+{
+    for (size_t s = 0; s < sequences_.size(); ++s) {
+        if (!sequences_[s].active) {
+            sequences_[s] = Sequence();
+            sequences_[s].active = true;
+            return (int)s;
+        }
+    }
+    sequences_.emplace_back();
+    sequences_.back().active = true;
+    return (int)sequences_.size() - 1;
+}
+
+void KVCache::release_sequence(int seq)
+{
+    truncate(seq, 0);
+    sequence(seq).active = false;
+}
+
+const KVCache::Sequence& KVCache::sequence(int seq) const
+{
+    if (seq < 0 || seq >= (int)sequences_.size() || !sequences_[seq].active) {
+        throw std::out_of_range("Unknown sequence id.");
+    }
+    return sequences_[seq];
+}
+
+KVCache::Sequence& KVCache::sequence(int seq)
+{
+    return const_cast<Sequence&>(static_cast<const KVCache*>(this)->sequence(seq));
+}
+
+size_t KVCache::page_offset(int page, int h) const
+{
+    return ((size_t)page * heads_ + h) * page_size_ * head_dim_;
+}
+
+void KVCache::append(int seq, const float* key, const float* value)
+{
+    Sequence& s = sequence(seq);
+    int slot = s.length % page_size_;
+    if (slot == 0) {
+        if (free_pages_.empty()) {
+            throw std::length_error("KV cache is full.");
+        }
+        s.pages.push_back(free_pages_.back());
+        free_pages_.pop_back();
+    }
+    int page = s.pages.back();
+    for (int h = 0; h < heads_; ++h) {
+        size_t offset = page_offset(page, h) + (size_t)slot * head_dim_;
+        std::copy(key + (size_t)h * head_dim_, key + (size_t)(h + 1) * head_dim_, keys_.begin() + offset);
+        std::copy(value + (size_t)h * head_dim_, value + (size_t)(h + 1) * head_dim_, values_.begin() + offset);
+    }
+    ++s.length;
+}
+
+void KVCache::append(int seq, const std::vector<float>& key, const std::vector<float>& value)
+{
+    if (key.size() != (size_t)heads_ * head_dim_ || value.size() != (size_t)heads_ * head_dim_) {
+        throw std::invalid_argument("Key and value must be heads * head_dim.");
+    }
+    append(seq, key.data(), value.data());
+}
+
+void KVCache::truncate(int seq, int length)
+{
+    Sequence& s = sequence(seq);
+    if (length < 0 || length > s.length) {
+        throw std::out_of_range("Truncation length is out of range.");
+    }
+    size_t pages_needed = (length + page_size_ - 1) / page_size_;
+    while (s.pages.size() > pages_needed) {
+        free_pages_.push_back(s.pages.back());
+        s.pages.pop_back();
+    }
+    s.length = length;
+}
+
+int KVCache::length(int seq) const
+{
+    return sequence(seq).length;
+}
+
+const float* KVCache::key_block(int seq, int n, int h) const
+{
+    return keys_.data() + page_offset(sequence(seq).pages.at(n), h);
+}
+
+const float* KVCache::value_block(int seq, int n, int h) const
+{
+    return values_.data() + page_offset(sequence(seq).pages.at(n), h);
+}
+
+void decode_attention(const KVCache& cache, int seq, const std::vector<float>& query,
+                      std::vector<float>& out, float scale)
+{
+    const int heads = cache.heads(), d = cache.head_dim(), page_size = cache.page_size();
+    if (query.size() != (size_t)heads * d) {
+        throw std::invalid_argument("Query must be heads * head_dim.");
+    }
+    if (scale == 0.0f) {
+        scale = 1.0f / std::sqrt((float)d);
+    }
+    const int length = cache.length(seq);
+    const int num_pages = (length + page_size - 1) / page_size;
+    out.assign((size_t)heads * d, 0.0f);
+    std::vector<float> scores(page_size);
+
+    for (int h = 0; h < heads; ++h) {
+        const float* q = query.data() + (size_t)h * d;
+        float* o = out.data() + (size_t)h * d;
+        float row_max = -std::numeric_limits<float>::infinity();
+        float row_sum = 0.0f;
+
+        for (int n = 0; n < num_pages; ++n) {
+            int tokens = std::min(page_size, length - n * page_size);
+            const float* k = cache.key_block(seq, n, h);
+            const float* v = cache.value_block(seq, n, h);
+
+            float page_max = -std::numeric_limits<float>::infinity();
+            for (int t = 0; t < tokens; ++t) {
+                const float* k_row = k + (size_t)t * d;
+                float dot = 0.0f;
+                for (int x = 0; x < d; ++x) {
+                    dot += q[x] * k_row[x];
+                }
+                scores[t] = dot * scale;
+                page_max = std::max(page_max, scores[t]);
+            }
+            float new_max = std::max(row_max, page_max);
+            float correction = row_sum > 0.0f ? fast_exp(row_max - new_max) : 0.0f;
+            row_sum *= correction;
+            for (int x = 0; x < d; ++x) {
+                o[x] *= correction;
+            }
+            for (int t = 0; t < tokens; ++t) {
+                float p = fast_exp(scores[t] - new_max);
+                row_sum += p;
+                const float* v_row = v + (size_t)t * d;
+                for (int x = 0; x < d; ++x) {
+                    o[x] += p * v_row[x];
+                }
+            }
+            row_max = new_max;
+        }
+
+        float inv = row_sum > 0.0f ? 1.0f / row_sum : 0.0f;
+        for (int x = 0; x < d; ++x) {
+            o[x] *= inv;
+        }
+    }
+}
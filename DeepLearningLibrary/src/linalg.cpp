@@ -0,0 +1,86 @@
+//
+//  linalg.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Dense linear algebra used by the layers.
+//  The loops are ordered so that the innermost loop walks contiguous memory in both C and B,
+//  which lets the compiler vectorize it, and the k dimension is blocked so that a panel of B
+//  stays in cache while it is reused for every row of A.
+//
+#include <algorithm>
+#include <stdexcept>
+#include "../headers/linalg.h"
+
+static const int GEMM_BLOCK_K = 256;
+static const int GEMM_BLOCK_M = 64;
+
+void gemm(bool trans_a, bool trans_b, int m, int n, int k,
+          float alpha, const float* a, int lda,
+          const float* b, int ldb,
+          float beta, float* c, int ldc)
+{
+    if (m < 0 || n < 0 || k < 0) {
+        throw std::invalid_argument("Matrix dimensions must be non-negative.");
+    }
+
+    // C = beta * C
+    for (int i = 0; i < m; ++i) {
+        float* c_row = c + (size_t)i * ldc;
+        if (beta == 0.0f) {
+            std::fill(c_row, c_row + n, 0.0f);
+        } else if (beta != 1.0f) {
+            for (int j = 0; j < n; ++j) c_row[j] *= beta;
+        }
+    }
+    if (alpha == 0.0f || k == 0) return;
+
+    if (!trans_b) {
+        // C[i][:] += alpha * A(i, p) * B[p][:], B rows are contiguous
+        for (int p0 = 0; p0 < k; p0 += GEMM_BLOCK_K) {
+            int p1 = std::min(p0 + GEMM_BLOCK_K, k);
+            for (int i0 = 0; i0 < m; i0 += GEMM_BLOCK_M) {
+                int i1 = std::min(i0 + GEMM_BLOCK_M, m);
+                for (int i = i0; i < i1; ++i) {
+                    float* c_row = c + (size_t)i * ldc;
+                    for (int p = p0; p < p1; ++p) {
+                        float a_ip = trans_a ? a[(size_t)p * lda + i] : a[(size_t)i * lda + p];
+                        if (a_ip == 0.0f) continue;
+                        a_ip *= alpha;
+                        const float* b_row = b + (size_t)p * ldb;
+                        for (int j = 0; j < n; ++j) {
+                            c_row[j] += a_ip * b_row[j];
+                        }
+                    }
+                }
+            }
+        }
+    } else if (!trans_a) {
+        // C[i][j] += alpha * dot(A[i][:], B[j][:]), both rows are contiguous
+        for (int i = 0; i < m; ++i) {
+            const float* a_row = a + (size_t)i * lda;
+            float* c_row = c + (size_t)i * ldc;
+            for (int j = 0; j < n; ++j) {
+                const float* b_row = b + (size_t)j * ldb;
+                float sum = 0.0f;
+                for (int p = 0; p < k; ++p) {
+                    sum += a_row[p] * b_row[p];
+                }
+                c_row[j] += alpha * sum;
+            }
+        }
+    } else {
+        // Both transposed, rarely used: C[i][j] += alpha * sum_p A[p][i] * B[j][p]
+        for (int i = 0; i < m; ++i) {
+            float* c_row = c + (size_t)i * ldc;
+            for (int j = 0; j < n; ++j) {
+                const float* b_row = b + (size_t)j * ldb;
+                float sum = 0.0f;
+                for (int p = 0; p < k; ++p) {
+                    sum += a[(size_t)p * lda + i] * b_row[p];
+                }
+                c_row[j] += alpha * sum;
+            }
+        }
+    }
+}
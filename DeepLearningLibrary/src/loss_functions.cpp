@@ -2,6 +2,17 @@
 #include <cmath>    // For mathematical functions
 #include <vector>   
 #include <stdexcept> // For exception handling
+#include <algorithm>
+#include "../headers/sequence.h"
+#include "../headers/thread_pool.h"
+
+static float add(float a, float b) { return a + b; }
+
+// Rows of row_size values per parallel chunk, about ELEMENTWISE_GRAIN values
+static size_t row_grain(size_t row_size)
+{
+    return std::max<size_t>(1, ELEMENTWISE_GRAIN / std::max<size_t>(1, row_size));
+}
 
 // Mean Squared Error (MSE) Loss Function
 // This function calculates the mean squared error between predictions and targets.
@@ -19,11 +30,14 @@ float mean_squared_error(const std::vector<float>& predictions, const std::vecto
         throw std::invalid_argument("Predictions and targets must have the same size.");
     }
     
-    float mse = 0.0f;
-    for (size_t i = 0; i < predictions.size(); ++i) {
-        float error = predictions[i] - targets[i];
-        mse += error * error;
-    }
+    float mse = parallel_reduce(0, predictions.size(), ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            float error = predictions[i] - targets[i];
+            sum += error * error;
+        }
+        return sum;
+    }, add);
     
     return mse / predictions.size();
 }
@@ -60,16 +74,19 @@ float binary_cross_entropy(const std::vector<float>& predictions, const std::vec
     // Check if predictions and targets are in the range [0, 1]
     // This is important to avoid log(0) which is undefined.
     // If predictions or targets are outside this range, throw an exception.
-    float bce = 0.0f;
-    for (size_t i = 0; i < predictions.size(); ++i) {
-        if (predictions[i] < 0.0f || predictions[i] > 1.0f) {
-            throw std::out_of_range("Predictions must be in the range [0, 1].");
-        }
-        if (targets[i] < 0.0f || targets[i] > 1.0f) {
-            throw std::out_of_range("Targets must be in the range [0, 1].");
+    float bce = parallel_reduce(0, predictions.size(), ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            if (predictions[i] < 0.0f || predictions[i] > 1.0f) {
+                throw std::out_of_range("Predictions must be in the range [0, 1].");
+            }
+            if (targets[i] < 0.0f || targets[i] > 1.0f) {
+                throw std::out_of_range("Targets must be in the range [0, 1].");
+            }
+            sum += targets[i] * std::log(predictions[i]) + (1 - targets[i]) * std::log(1 - predictions[i]);
         }
-        bce += targets[i] * std::log(predictions[i]) + (1 - targets[i]) * std::log(1 - predictions[i]);
-    }   
+        return sum;
+    }, add);
     return -bce / predictions.size();
 }
 
@@ -78,10 +95,13 @@ float mean_absolute_error(const std::vector<float>& predictions, const std::vect
         throw std::invalid_argument("Predictions and targets must have the same size.");
     }
     
-    float mae = 0.0f;
-    for (size_t i = 0; i < predictions.size(); ++i) {
-        mae += std::abs(predictions[i] - targets[i]);
-    }
+    float mae = parallel_reduce(0, predictions.size(), ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            sum += std::abs(predictions[i] - targets[i]);
+        }
+        return sum;
+    }, add);
     
     return mae / predictions.size();
 }
@@ -108,18 +128,21 @@ float categorical_cross_entropy(const std::vector<std::vector<float>>& predictio
         throw std::invalid_argument("Predictions and targets must have the same size.");
     }
     
-    float cce = 0.0f;
-    for (size_t i = 0; i < predictions.size(); ++i) {
-        if (predictions[i].size() != targets[i].size()) {
-            throw std::invalid_argument("Each prediction and target must have the same number of classes.");
-        }
-        
-        for (size_t j = 0; j < predictions[i].size(); ++j) {
-            if (targets[i][j] == 1.0f) {
-                cce -= std::log(predictions[i][j]);
+    size_t grain = row_grain(predictions.empty() ? 1 : predictions[0].size());
+    float cce = parallel_reduce(0, predictions.size(), grain, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            if (predictions[i].size() != targets[i].size()) {
+                throw std::invalid_argument("Each prediction and target must have the same number of classes.");
+            }
+            for (size_t j = 0; j < predictions[i].size(); ++j) {
+                if (targets[i][j] == 1.0f) {
+                    sum -= std::log(predictions[i][j]);
+                }
             }
         }
-    }
+        return sum;
+    }, add);
     
     return cce / predictions.size();
 }
@@ -138,15 +161,18 @@ float huber_loss(const std::vector<float>& predictions, const std::vector<float>
         throw std::invalid_argument("Predictions and targets must have the same size.");
     }
     
-    float loss = 0.0f;
-    for (size_t i = 0; i < predictions.size(); ++i) {
-        float error = predictions[i] - targets[i];
-        if (std::abs(error) <= delta) {
-            loss += 0.5f * error * error; // Quadratic loss
-        } else {
-            loss += delta * (std::abs(error) - 0.5f * delta); // Linear loss
+    float loss = parallel_reduce(0, predictions.size(), ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            float error = predictions[i] - targets[i];
+            if (std::abs(error) <= delta) {
+                sum += 0.5f * error * error; // Quadratic loss
+            } else {
+                sum += delta * (std::abs(error) - 0.5f * delta); // Linear loss
+            }
         }
-    }
+        return sum;
+    }, add);
     
     return loss / predictions.size();
 }
@@ -170,13 +196,17 @@ float sparse_categorical_cross_entropy(const std::vector<std::vector<float>>& pr
         throw std::invalid_argument("Predictions and targets must have the same size.");
     }
     
-    float loss = 0.0f;
-    for (size_t i = 0; i < predictions.size(); ++i) {
-        if (targets[i] < 0 || targets[i] >= predictions[i].size()) {
-            throw std::out_of_range("Target index is out of range for predictions.");
+    // One log per row, so the chunks are counted in rows
+    float loss = parallel_reduce(0, predictions.size(), ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            if (targets[i] < 0 || targets[i] >= predictions[i].size()) {
+                throw std::out_of_range("Target index is out of range for predictions.");
+            }
+            sum -= std::log(predictions[i][targets[i]]);
         }
-        loss -= std::log(predictions[i][targets[i]]);
-    }
+        return sum;
+    }, add);
     
     return loss / predictions.size();
 }
@@ -193,22 +223,26 @@ float kullback_leibler_divergence(const std::vector<std::vector<float>>& predict
     if (predictions.size() != targets.size()) {
         throw std::invalid_argument("Predictions and targets must have the same size.");
     }           
-    float kl_div = 0.0f;
-    for (size_t i = 0; i < predictions.size(); ++i) {
-        if (predictions[i].size() != targets[i].size()) {
-            throw std::invalid_argument("Each prediction and target must have the same number of classes.");
-        }   
-        for (size_t j = 0; j < predictions[i].size(); ++j) {
-            if (predictions[i][j] < 0.0f || predictions[i][j] > 1.0f) {
-                throw std::out_of_range("Predictions must be in the range [0, 1].");
+    size_t grain = row_grain(predictions.empty() ? 1 : predictions[0].size());
+    float kl_div = parallel_reduce(0, predictions.size(), grain, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            if (predictions[i].size() != targets[i].size()) {
+                throw std::invalid_argument("Each prediction and target must have the same number of classes.");
             }
-            if (targets[i][j] < 0.0f || targets[i][j] > 1.0f) {
-                throw std::out_of_range("Targets must be in the range [0, 1].");
+            for (size_t j = 0; j < predictions[i].size(); ++j) {
+                if (predictions[i][j] < 0.0f || predictions[i][j] > 1.0f) {
+                    throw std::out_of_range("Predictions must be in the range [0, 1].");
+                }
+                if (targets[i][j] < 0.0f || targets[i][j] > 1.0f) {
+                    throw std::out_of_range("Targets must be in the range [0, 1].");
+                }
+                if (targets[i][j] == 0.0f) continue; // Avoid log(0)
+                sum += targets[i][j] * std::log(targets[i][j] / predictions[i][j]);
             }
-            if (targets[i][j] == 0.0f) continue; // Avoid log(0)
-            kl_div += targets[i][j] * std::log(targets[i][j] / predictions[i][j]);
         }
-    }
+        return sum;
+    }, add);
     return kl_div / predictions.size();
 }
 
@@ -226,15 +260,73 @@ float hinge_loss(const std::vector<float>& predictions, const std::vector<int>&
     if (predictions.size() != targets.size()) {
         throw std::invalid_argument("Predictions and targets must have the same size.");
     }   
-    float loss = 0.0f;
-    for (size_t i = 0; i < predictions.size(); ++i) {
-        if (targets[i] != -1 && targets[i] != 1) {
-            throw std::invalid_argument("Targets must be -1 or 1.");
+    float loss = parallel_reduce(0, predictions.size(), ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            if (targets[i] != -1 && targets[i] != 1) {
+                throw std::invalid_argument("Targets must be -1 or 1.");
+            }
+            float margin = 1.0f - targets[i] * predictions[i];
+            if (margin > 0) {
+                sum += margin; // Only add positive margins
+            }
         }
-        float margin = 1.0f - targets[i] * predictions[i];  
-        if (margin > 0) {
-            loss += margin; // Only add positive margins
+        return sum;
+    }, add);
+    return loss / predictions.size();
+}
+
+// Masked losses over packed sequences
+// Padding a batch of sequences to the longest one and masking the padded positions still walks
+// batch * max_len positions. A PackedSequence only stores the real tokens, so these losses walk
+// total_tokens rows and the average is taken over the real tokens only.
+
+// Packed Mean Squared Error
+// MSE = 1/(T * f) * Σ(predictions_i - targets_i)^2 over the T tokens of f features
+// It throws an exception if the two packed sequences do not have the same layout.
+float packed_mean_squared_error(const PackedSequence& predictions, const PackedSequence& targets) {
+    if (predictions.feature_size != targets.feature_size || predictions.batch_sizes != targets.batch_sizes ||
+        predictions.data.size() != targets.data.size()) {
+        throw std::invalid_argument("Predictions and targets must have the same packed layout.");
+    }
+    if (predictions.data.empty()) {
+        throw std::invalid_argument("Predictions and targets cannot be empty.");
+    }
+
+    float mse = parallel_reduce(0, predictions.data.size(), ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; ++i) {
+            float error = predictions.data[i] - targets.data[i];
+            sum += error * error;
         }
+        return sum;
+    }, add);
+    return mse / predictions.data.size();
+}
+
+// Packed Sparse Categorical Cross-Entropy
+// predictions holds one probability distribution over feature_size classes per token,
+// targets one class index per token in the same packed order (see pack_labels).
+// L = -1/T * Σ log(ŷ_t[y_t]) over the T tokens
+float packed_sparse_categorical_cross_entropy(const PackedSequence& predictions, const std::vector<int>& targets) {
+    size_t tokens = predictions.total_tokens();
+    if (tokens != targets.size()) {
+        throw std::invalid_argument("There must be one target per packed token.");
     }
-    return loss / predictions.size();
-}
\ No newline at end of file
+    if (tokens == 0) {
+        throw std::invalid_argument("Predictions and targets cannot be empty.");
+    }
+
+    int classes = predictions.feature_size;
+    float loss = parallel_reduce(0, tokens, ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t t = begin; t < end; ++t) {
+            if (targets[t] < 0 || targets[t] >= classes) {
+                throw std::out_of_range("Target index is out of range for predictions.");
+            }
+            sum -= std::log(predictions.data[t * classes + targets[t]]);
+        }
+        return sum;
+    }, add);
+    return loss / tokens;
+}
@@ -0,0 +1,493 @@
+//
+//  network.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Dense layers and a multi-layer perceptron built on the in-place activations.
+//  The activations are applied in place on the layer output, and the backward pass computes the
+//  activation gradients from that output (see activation_funcs_gradient.cpp), so each layer only
+//  stores one buffer. On top of that the MLP can discard intermediate activations in the forward
+//  pass and recompute them in the backward pass (activation checkpointing).
+//
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+#include "../headers/network.h"
+#include "../headers/linalg.h"
+#include "../headers/activation_functions.h"
+#include "../headers/activation_funcs_gradient.h"
+#include "../headers/vector_math.h"
+#include "../headers/thread_pool.h"
+
+void activation_forward_inplace(Activation activation, float* x, size_t n)
+{
+    switch (activation) {
+        case Activation::Identity: break;
+        case Activation::ReLU: relu_inplace(x, n); break;
+        case Activation::Sigmoid: sigmoid_inplace(x, n); break;
+        case Activation::Tanh: tanh_inplace(x, n); break;
+        case Activation::ELU: elu_inplace(x, n); break;
+        case Activation::Softplus: softplus_inplace(x, n); break;
+        case Activation::ReLU6: relu6_inplace(x, n); break;
+        case Activation::Hardtanh: hardtanh_inplace(x, n); break;
+        case Activation::Hardsigmoid: hardsigmoid_inplace(x, n); break;
+    }
+}
+
+void activation_forward_inplace(Activation activation, std::vector<float>& x)
+{
+    activation_forward_inplace(activation, x.data(), x.size());
+}
+
+void activation_backward_inplace(Activation activation, const std::vector<float>& output, std::vector<float>& grad)
+{
+    switch (activation) {
+        case Activation::Identity: break;
+        case Activation::ReLU: relu_backward_inplace(output, grad); break;
+        case Activation::Sigmoid: sigmoid_backward_inplace(output, grad); break;
+        case Activation::Tanh: tanh_backward_inplace(output, grad); break;
+        case Activation::ELU: elu_backward_inplace(output, grad); break;
+        case Activation::Softplus: softplus_backward_inplace(output, grad); break;
+        case Activation::ReLU6: relu6_backward_inplace(output, grad); break;
+        case Activation::Hardtanh: hardtanh_backward_inplace(output, grad); break;
+        case Activation::Hardsigmoid: hardsigmoid_backward_inplace(output, grad); break;
+    }
+}
+
+// Release the memory of a buffer, clear() alone keeps the capacity
+static void release(std::vector<float>& v)
+{
+    std::vector<float>().swap(v);
+}
+
+// Element count of a rows x cols buffer. Called in the member initializers, so that bad sizes
+// throw std::invalid_argument before anything is allocated with them.
+static size_t checked_size(int rows, int cols, const char* message)
+{
+    if (rows <= 0 || cols <= 0) {
+        throw std::invalid_argument(message);
+    }
+    return (size_t)rows * cols;
+}
+
+// Dense layer
+
+// Weights use Xavier/Glorot uniform initialization: U(-limit, limit), limit = sqrt(6 / (in + out))
+Dense::Dense(int in_features, int out_features, Activation activation, unsigned seed)
+    : in_features(in_features), out_features(out_features), activation(activation),
+      weights(checked_size(in_features, out_features, "Layer sizes must be positive.")), bias(out_features, 0.0f),
+      grad_weights((size_t)in_features * out_features, 0.0f), grad_bias(out_features, 0.0f)
+{
+    std::mt19937 gen(seed);
+    float limit = std::sqrt(6.0f / (in_features + out_features));
+    std::uniform_real_distribution<float> dist(-limit, limit);
+    for (float& w : weights) {
+        w = dist(gen);
+    }
+}
+
+void Dense::forward(const std::vector<float>& input, std::vector<float>& output, int batch) const
+{
+    if (input.size() != (size_t)batch * in_features) {
+        throw std::invalid_argument("Input size does not match batch * in_features.");
+    }
+    output.resize((size_t)batch * out_features);
+    for (int b = 0; b < batch; ++b) {
+        std::copy(bias.begin(), bias.end(), output.begin() + (size_t)b * out_features);
+    }
+    gemm(false, false, batch, out_features, in_features,
+         1.0f, input.data(), in_features, weights.data(), out_features,
+         1.0f, output.data(), out_features);
+    activation_forward_inplace(activation, output);
+}
+
+void Dense::backward(const std::vector<float>& input, const std::vector<float>& output,
+                     std::vector<float>& grad_output, std::vector<float>& grad_input, int batch)
+{
+    if (grad_output.size() != (size_t)batch * out_features) {
+        throw std::invalid_argument("Gradient size does not match batch * out_features.");
+    }
+    activation_backward_inplace(activation, output, grad_output);
+
+    // dL/db = sum over the batch of dL/dz
+    for (int b = 0; b < batch; ++b) {
+        const float* g = grad_output.data() + (size_t)b * out_features;
+        for (int j = 0; j < out_features; ++j) {
+            grad_bias[j] += g[j];
+        }
+    }
+    // dL/dW += x^T * dL/dz
+    gemm(true, false, in_features, out_features, batch,
+         1.0f, input.data(), in_features, grad_output.data(), out_features,
+         1.0f, grad_weights.data(), out_features);
+    // dL/dx = dL/dz * W^T
+    grad_input.resize((size_t)batch * in_features);
+    gemm(false, true, batch, in_features, out_features,
+         1.0f, grad_output.data(), out_features, weights.data(), out_features,
+         0.0f, grad_input.data(), in_features);
+}
+
+void Dense::zero_grad()
+{
+    std::fill(grad_weights.begin(), grad_weights.end(), 0.0f);
+    std::fill(grad_bias.begin(), grad_bias.end(), 0.0f);
+}
+
+// Channel-wise PReLU
+
+// Rows of channels values in one parallel chunk, below that the pool costs more than it saves
+static const size_t PRELU_ROW_GRAIN = 4096;
+
+ChannelPReLU::ChannelPReLU(int channels, float initial_alpha)
+    : channels(channels), alpha(checked_size(channels, 1, "Number of channels must be positive."), initial_alpha),
+      grad_alpha(channels, 0.0f)
+{
+}
+
+void ChannelPReLU::forward(const std::vector<float>& input, std::vector<float>& output) const
+{
+    if (input.size() % channels != 0) {
+        throw std::invalid_argument("Input size must be a multiple of the number of channels.");
+    }
+    output.resize(input.size());
+    size_t rows = input.size() / channels;
+    const float* a = alpha.data();
+    parallel_for(0, rows, PRELU_ROW_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            const float* x = input.data() + r * channels;
+            float* y = output.data() + r * channels;
+            for (int c = 0; c < channels; ++c) {
+                y[c] = x[c] > 0.0f ? x[c] : a[c] * x[c];
+            }
+        }
+    });
+}
+
+// dL/dx = g if x > 0, alpha[c] * g otherwise
+// dL/dalpha[c] = sum over every position of channel c of g * min(x, 0)
+// Each chunk of rows sums its dalpha into its own buffer and the partial sums are added in
+// chunk order, so the result does not depend on scheduling.
+void ChannelPReLU::backward(const std::vector<float>& input, const std::vector<float>& grad_output,
+                            std::vector<float>& grad_input)
+{
+    if (input.size() % channels != 0 || grad_output.size() != input.size()) {
+        throw std::invalid_argument("Input and gradient must be the same multiple of the number of channels.");
+    }
+    grad_input.resize(input.size());
+    size_t rows = input.size() / channels;
+
+    std::vector<float> dalpha = parallel_reduce(0, rows, PRELU_ROW_GRAIN, std::vector<float>(channels, 0.0f),
+        [&](size_t begin, size_t end) {
+            std::vector<float> partial(channels, 0.0f);
+            const float* a = alpha.data();
+            float* da = partial.data();
+            for (size_t r = begin; r < end; ++r) {
+                const float* x = input.data() + r * channels;
+                const float* g = grad_output.data() + r * channels;
+                float* dx = grad_input.data() + r * channels;
+                for (int c = 0; c < channels; ++c) {
+                    bool positive = x[c] > 0.0f;
+                    dx[c] = positive ? g[c] : a[c] * g[c];
+                    da[c] += positive ? 0.0f : g[c] * x[c];
+                }
+            }
+            return partial;
+        },
+        [](std::vector<float> sum, const std::vector<float>& partial) {
+            for (size_t c = 0; c < sum.size(); ++c) {
+                sum[c] += partial[c];
+            }
+            return sum;
+        });
+
+    for (int c = 0; c < channels; ++c) {
+        grad_alpha[c] += dalpha[c];
+    }
+}
+
+void ChannelPReLU::zero_grad()
+{
+    std::fill(grad_alpha.begin(), grad_alpha.end(), 0.0f);
+}
+
+// Radial basis function layer
+// ||x - c||^2 = ||x||^2 + ||c||^2 - 2 x.c, so all the batch x centers distances come from one
+// GEMM (X * C^T) plus the row norms, instead of a loop over every (row, center, feature).
+// The gaussian is then applied in one vectorized pass over the distance matrix.
+
+RBF::RBF(int in_features, int num_centers, float gamma, unsigned seed)
+    : in_features(in_features), num_centers(num_centers), gamma(gamma),
+      centers(checked_size(num_centers, in_features, "Layer sizes must be positive.")),
+      grad_centers((size_t)num_centers * in_features, 0.0f)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& c : centers) {
+        c = dist(gen);
+    }
+}
+
+static std::vector<float> squared_row_norms(const float* m, int rows, int cols)
+{
+    std::vector<float> norms(rows);
+    for (int r = 0; r < rows; ++r) {
+        const float* row = m + (size_t)r * cols;
+        float sum = 0.0f;
+        for (int j = 0; j < cols; ++j) {
+            sum += row[j] * row[j];
+        }
+        norms[r] = sum;
+    }
+    return norms;
+}
+
+void RBF::forward(const std::vector<float>& input, std::vector<float>& output, int batch) const
+{
+    if (input.size() != (size_t)batch * in_features) {
+        throw std::invalid_argument("Input size does not match batch * in_features.");
+    }
+    output.resize((size_t)batch * num_centers);
+    // output = -2 X C^T
+    gemm(false, true, batch, num_centers, in_features, -2.0f, input.data(), in_features,
+         centers.data(), in_features, 0.0f, output.data(), num_centers);
+
+    std::vector<float> x_norms = squared_row_norms(input.data(), batch, in_features);
+    std::vector<float> c_norms = squared_row_norms(centers.data(), num_centers, in_features);
+    for (int b = 0; b < batch; ++b) {
+        float* y = output.data() + (size_t)b * num_centers;
+        for (int k = 0; k < num_centers; ++k) {
+            // Rounding can make the expanded distance slightly negative
+            float d2 = std::max(y[k] + x_norms[b] + c_norms[k], 0.0f);
+            y[k] = fast_exp(-gamma * d2);
+        }
+    }
+}
+
+// With A = dL/dy * dy/d(d2) = -gamma * y * dL/dy:
+//  dL/dx_b = 2 * (Σ_k A_bk) * x_b - 2 * (A C)_b
+//  dL/dc_k = 2 * (Σ_b A_bk) * c_k - 2 * (A^T X)_k
+void RBF::backward(const std::vector<float>& input, const std::vector<float>& output,
+                   const std::vector<float>& grad_output, std::vector<float>& grad_input, int batch)
+{
+    if (input.size() != (size_t)batch * in_features || output.size() != (size_t)batch * num_centers ||
+        grad_output.size() != output.size()) {
+        throw std::invalid_argument("Input, output and gradient sizes do not match the layer.");
+    }
+    std::vector<float> a(output.size());
+    std::vector<float> row_sums(batch, 0.0f), col_sums(num_centers, 0.0f);
+    for (int b = 0; b < batch; ++b) {
+        const float* y = output.data() + (size_t)b * num_centers;
+        const float* g = grad_output.data() + (size_t)b * num_centers;
+        float* a_row = a.data() + (size_t)b * num_centers;
+        float sum = 0.0f;
+        for (int k = 0; k < num_centers; ++k) {
+            a_row[k] = -gamma * y[k] * g[k];
+            sum += a_row[k];
+            col_sums[k] += a_row[k];
+        }
+        row_sums[b] = sum;
+    }
+
+    grad_input.resize(input.size());
+    for (int b = 0; b < batch; ++b) {
+        const float* x = input.data() + (size_t)b * in_features;
+        float* dx = grad_input.data() + (size_t)b * in_features;
+        for (int j = 0; j < in_features; ++j) {
+            dx[j] = 2.0f * row_sums[b] * x[j];
+        }
+    }
+    gemm(false, false, batch, in_features, num_centers, -2.0f, a.data(), num_centers,
+         centers.data(), in_features, 1.0f, grad_input.data(), in_features);
+
+    for (int k = 0; k < num_centers; ++k) {
+        const float* c = centers.data() + (size_t)k * in_features;
+        float* dc = grad_centers.data() + (size_t)k * in_features;
+        for (int j = 0; j < in_features; ++j) {
+            dc[j] += 2.0f * col_sums[k] * c[j];
+        }
+    }
+    gemm(true, false, num_centers, in_features, batch, -2.0f, a.data(), num_centers,
+         input.data(), in_features, 1.0f, grad_centers.data(), in_features);
+}
+
+void RBF::zero_grad()
+{
+    std::fill(grad_centers.begin(), grad_centers.end(), 0.0f);
+}
+
+// Multi-layer perceptron
+
+MLP::MLP(const std::vector<int>& sizes, Activation hidden_activation, Activation output_activation, unsigned seed)
+{
+    if (sizes.size() < 2) {
+        throw std::invalid_argument("An MLP needs at least an input and an output size.");
+    }
+    size_t num_layers = sizes.size() - 1;
+    for (size_t i = 0; i < num_layers; ++i) {
+        Activation act = (i + 1 == num_layers) ? output_activation : hidden_activation;
+        layers_.emplace_back(sizes[i], sizes[i + 1], act, seed + (unsigned)i);
+    }
+    keep_.assign(num_layers + 1, true);
+    activations_.resize(num_layers + 1);
+}
+
+const std::vector<float>& MLP::forward(const std::vector<float>& input, int batch)
+{
+    size_t num_layers = layers_.size();
+    batch_ = batch;
+    activations_[0] = input;
+    for (size_t i = 0; i < num_layers; ++i) {
+        layers_[i].forward(activations_[i], activations_[i + 1], batch);
+        // Activation i has been consumed, drop it unless it is a checkpoint
+        if (!keep_[i]) {
+            release(activations_[i]);
+        }
+    }
+    return activations_[num_layers];
+}
+
+// Recompute the activations strictly between the checkpoints start and end
+void MLP::recompute_segment(int start, int end)
+{
+    for (int i = start; i + 1 < end; ++i) {
+        layers_[i].forward(activations_[i], activations_[i + 1], batch_);
+    }
+}
+
+std::vector<float> MLP::backward(const std::vector<float>& grad_output)
+{
+    int num_layers = (int)layers_.size();
+    if (activations_[num_layers].empty()) {
+        throw std::logic_error("backward() called before forward().");
+    }
+    std::vector<float> grad = grad_output;
+    std::vector<float> grad_input;
+
+    int end = num_layers;
+    while (end > 0) {
+        int start = end - 1;
+        while (!keep_[start]) {
+            --start;
+        }
+        recompute_segment(start, end);
+        for (int i = end - 1; i >= start; --i) {
+            layers_[i].backward(activations_[i], activations_[i + 1], grad, grad_input, batch_);
+            grad.swap(grad_input);
+            // The output of layer i is not needed anymore
+            if (i + 1 < num_layers) {
+                release(activations_[i + 1]);
+            }
+        }
+        end = start;
+    }
+    return grad;
+}
+
+void MLP::zero_grad()
+{
+    for (Dense& layer : layers_) {
+        layer.zero_grad();
+    }
+}
+
+void MLP::set_checkpoints(const std::vector<bool>& keep)
+{
+    if (keep.size() != layers_.size() + 1) {
+        throw std::invalid_argument("Checkpoint mask must have one entry per activation.");
+    }
+    keep_ = keep;
+    keep_.front() = true;
+    keep_.back() = true;
+}
+
+void MLP::disable_checkpointing()
+{
+    keep_.assign(layers_.size() + 1, true);
+}
+
+// Peak memory of a training step:
+//  the kept activations
+//  + the largest segment being recomputed in the backward pass
+//  + two gradient buffers of the widest activation
+size_t MLP::peak_activation_bytes(const std::vector<bool>& keep, int batch) const
+{
+    size_t num_layers = layers_.size();
+    std::vector<size_t> bytes(num_layers + 1);
+    bytes[0] = (size_t)batch * layers_[0].in_features * sizeof(float);
+    for (size_t i = 0; i < num_layers; ++i) {
+        bytes[i + 1] = (size_t)batch * layers_[i].out_features * sizeof(float);
+    }
+
+    size_t kept = 0, segment = 0, largest_segment = 0;
+    for (size_t i = 0; i <= num_layers; ++i) {
+        if (keep[i]) {
+            kept += bytes[i];
+            largest_segment = std::max(largest_segment, segment);
+            segment = 0;
+        } else {
+            segment += bytes[i];
+        }
+    }
+    size_t widest = *std::max_element(bytes.begin(), bytes.end());
+    return kept + largest_segment + 2 * widest;
+}
+
+size_t MLP::peak_activation_bytes(int batch) const
+{
+    return peak_activation_bytes(keep_, batch);
+}
+
+// Candidate plans split the hidden activations into k segments of roughly equal size in bytes,
+// for every k. A plan with more checkpoints recomputes less, so among the plans that fit the
+// budget the one with the fewest discarded activations wins.
+size_t MLP::plan_checkpoints(size_t memory_budget_bytes, int batch)
+{
+    size_t num_layers = layers_.size();
+    std::vector<size_t> bytes(num_layers + 1);
+    size_t hidden_total = 0;
+    for (size_t i = 1; i < num_layers; ++i) {
+        bytes[i] = (size_t)batch * layers_[i - 1].out_features * sizeof(float);
+        hidden_total += bytes[i];
+    }
+
+    std::vector<bool> best(num_layers + 1, true);
+    size_t best_peak = peak_activation_bytes(best, batch);
+    size_t best_discarded = 0;
+    bool best_fits = best_peak <= memory_budget_bytes;
+    if (best_fits) {
+        keep_ = best;
+        return best_peak;
+    }
+
+    for (size_t k = 1; k < num_layers; ++k) {
+        std::vector<bool> keep(num_layers + 1, false);
+        keep.front() = true;
+        keep.back() = true;
+        size_t target = hidden_total / k;
+        size_t accumulated = 0, discarded = 0;
+        for (size_t i = 1; i < num_layers; ++i) {
+            if (accumulated >= target) {
+                keep[i] = true;
+                accumulated = 0;
+            } else {
+                accumulated += bytes[i];
+                ++discarded;
+            }
+        }
+
+        size_t peak = peak_activation_bytes(keep, batch);
+        bool fits = peak <= memory_budget_bytes;
+        bool better = fits ? (!best_fits || discarded < best_discarded ||
+                              (discarded == best_discarded && peak < best_peak))
+                           : (!best_fits && peak < best_peak);
+        if (better) {
+            best = keep;
+            best_peak = peak;
+            best_discarded = discarded;
+            best_fits = fits;
+        }
+    }
+    keep_ = best;
+    return best_peak;
+}
@@ -0,0 +1,240 @@
+//
+//  numa.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  NUMA topology from sysfs and page placement with the mbind system call.
+//  The system call is used directly rather than through libnuma, so the library has no extra
+//  dependency; on a kernel without NUMA support mbind fails and the calls return false.
+//
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+#include "../headers/numa.h"
+
+namespace {
+
+struct Topology {
+    std::vector<std::vector<int>> node_cpus;
+    std::vector<int> cpu_node;
+};
+
+// Parses a sysfs list such as "0-3,8,10-11"
+std::vector<int> parse_list(const std::string& text)
+{
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty() || item == "\n") continue;
+        size_t dash = item.find('-');
+        int first = std::stoi(item.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+        for (int v = first; v <= last; ++v) {
+            values.push_back(v);
+        }
+    }
+    return values;
+}
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream file(path);
+    std::string text;
+    std::getline(file, text);
+    return text;
+}
+
+Topology read_topology()
+{
+    Topology topology;
+    std::vector<int> nodes;
+    try {
+        nodes = parse_list(read_file("/sys/devices/system/node/online"));
+    } catch (...) {
+        nodes.clear();
+    }
+    for (int node : nodes) {
+        std::vector<int> cpus;
+        try {
+            cpus = parse_list(read_file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+        } catch (...) {
+            cpus.clear();
+        }
+        if (topology.node_cpus.size() <= (size_t)node) {
+            topology.node_cpus.resize(node + 1);
+        }
+        topology.node_cpus[node] = cpus;
+        for (int cpu : cpus) {
+            if (topology.cpu_node.size() <= (size_t)cpu) {
+                topology.cpu_node.resize(cpu + 1, 0);
+            }
+            topology.cpu_node[cpu] = node;
+        }
+    }
+    if (topology.node_cpus.empty()) {
+        // No sysfs: one node with every CPU
+        topology.node_cpus.resize(1);
+        int hardware = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < hardware; ++cpu) {
+            topology.node_cpus[0].push_back(cpu);
+        }
+    }
+    return topology;
+}
+
+const Topology& topology()
+{
+    static const Topology instance = read_topology();
+    return instance;
+}
+
+const uintptr_t PAGE_SIZE_FALLBACK = 4096;
+
+uintptr_t page_size()
+{
+#if defined(__linux__)
+    static const uintptr_t size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    return size;
+#else
+    return PAGE_SIZE_FALLBACK;
+#endif
+}
+
+#if defined(__linux__)
+// From linux/mempolicy.h
+const int MPOL_BIND_MODE = 2;
+const int MPOL_INTERLEAVE_MODE = 3;
+const unsigned MPOL_MF_MOVE_FLAG = 1u << 1;
+
+// mbind on the pages lying entirely inside [begin, end). The partial pages at the ends of a heap
+// buffer also hold neighbouring allocations, which must not be rebound or migrated with it.
+bool mbind_pages(uintptr_t begin, uintptr_t end, int mode, const std::vector<unsigned long>& mask)
+{
+    uintptr_t page = page_size();
+    begin = (begin + page - 1) & ~(page - 1);
+    end &= ~(page - 1);
+    if (end <= begin) {
+        return true;
+    }
+    long rc = syscall(SYS_mbind, (void*)begin, (unsigned long)(end - begin), mode, mask.data(),
+                      (unsigned long)(mask.size() * 8 * sizeof(unsigned long) + 1), MPOL_MF_MOVE_FLAG);
+    return rc == 0;
+}
+
+std::vector<unsigned long> node_mask(int node)
+{
+    const size_t bits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(node / bits + 1, 0);
+    mask[node / bits] |= 1ul << (node % bits);
+    return mask;
+}
+#endif
+
+// Node of pool thread i: the node of its CPU if pinned, else the node the calling thread runs on
+int pool_thread_node(int thread)
+{
+    int cpu = pool_thread_cpu(thread);
+#if defined(__linux__)
+    if (cpu < 0) {
+        cpu = sched_getcpu();
+    }
+#endif
+    return cpu < 0 ? 0 : numa_node_of_cpu(cpu);
+}
+
+} // namespace
+
+int numa_node_count()
+{
+    return (int)topology().node_cpus.size();
+}
+
+const std::vector<int>& numa_node_cpus(int node)
+{
+    if (node < 0 || node >= numa_node_count()) {
+        throw std::out_of_range("NUMA node does not exist.");
+    }
+    return topology().node_cpus[node];
+}
+
+int numa_node_of_cpu(int cpu)
+{
+    const std::vector<int>& cpu_node = topology().cpu_node;
+    return cpu >= 0 && (size_t)cpu < cpu_node.size() ? cpu_node[cpu] : 0;
+}
+
+bool numa_bind(void* data, size_t bytes, int node)
+{
+    if (node < 0 || node >= numa_node_count()) {
+        throw std::out_of_range("NUMA node does not exist.");
+    }
+#if defined(__linux__)
+    uintptr_t begin = (uintptr_t)data;
+    return mbind_pages(begin, begin + bytes, MPOL_BIND_MODE, node_mask(node));
+#else
+    (void)data; (void)bytes;
+    return true;
+#endif
+}
+
+bool numa_interleave(void* data, size_t bytes)
+{
+#if defined(__linux__)
+    std::vector<unsigned long> mask = node_mask(0);
+    for (int node = 1; node < numa_node_count(); ++node) {
+        std::vector<unsigned long> bit = node_mask(node);
+        mask.resize(std::max(mask.size(), bit.size()), 0);
+        for (size_t w = 0; w < bit.size(); ++w) mask[w] |= bit[w];
+    }
+    uintptr_t begin = (uintptr_t)data;
+    return mbind_pages(begin, begin + bytes, MPOL_INTERLEAVE_MODE, mask);
+#else
+    (void)data; (void)bytes;
+    return true;
+#endif
+}
+
+// A page shared by two threads' ranges goes to the thread owning its first byte, so the ranges
+// are cut at page boundaries before binding.
+bool numa_place_for_pool(void* data, size_t bytes, size_t grain_bytes)
+{
+    if (bytes == 0 || numa_node_count() == 1) {
+        return true;
+    }
+    grain_bytes = std::max<size_t>(1, grain_bytes);
+    size_t chunks = (bytes + grain_bytes - 1) / grain_bytes;
+    int n = num_threads();
+    uintptr_t base = (uintptr_t)data, page = page_size();
+    bool placed = true;
+    for (int i = 0; i < n; ++i) {
+        size_t first = chunks * i / n, last = chunks * (i + 1) / n;
+        if (first == last) continue;
+        uintptr_t begin = base + first * grain_bytes;
+        uintptr_t end = base + std::min(bytes, last * grain_bytes);
+        begin = first == 0 ? begin : (begin + page - 1) & ~(page - 1);
+        end = last == chunks ? end : (end + page - 1) & ~(page - 1);
+        if (begin < end) {
+            placed &= numa_bind((void*)begin, end - begin, pool_thread_node(i));
+        }
+    }
+    return placed;
+}
+
+void numa_first_touch(void* data, size_t bytes, size_t grain_bytes)
+{
+    char* bytes_data = static_cast<char*>(data);
+    parallel_for(0, bytes, std::max<size_t>(1, grain_bytes), [&](size_t begin, size_t end) {
+        std::memset(bytes_data + begin, 0, end - begin);
+    });
+}
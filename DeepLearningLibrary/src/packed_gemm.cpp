@@ -0,0 +1,351 @@
+//
+//  packed_gemm.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Packed layout of a k x n matrix for a layout (mr, nr, kc): the k rows are cut into blocks of
+//  kc rows (the last one shorter), the n columns into panels of nr (the last one zero padded).
+//  Block after block, panel after panel, each panel stored as depth x nr row-major:
+//    panel j0 of the block starting at row p0 is at p0 * padded_n + j0 * depth
+//  gemm_packed walks the same order: for each block and panel, the micro-kernel is called for
+//  every mr rows of A, reusing the panel (kc * nr floats, 16 KB for the AVX2 layout) from L1.
+//  The AVX2 kernel is compiled with a target attribute, the rest of the library keeps the
+//  baseline instruction set, and it is only called after checking the CPU at run time.
+//
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "../headers/packed_gemm.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DLLIB_GEMM_AVX2 1
+#endif
+
+static const int GENERIC_MR = 4;
+static const int GENERIC_NR = 8;
+static const int AVX2_MR = 6;
+static const int AVX2_NR = 16;
+static const int PACK_KC = 256;
+
+std::string GemmLayout::key() const
+{
+    return isa + ".mr" + std::to_string(mr) + ".nr" + std::to_string(nr) + ".kc" + std::to_string(kc);
+}
+
+static const GemmLayout GENERIC_LAYOUT = {"generic", GENERIC_MR, GENERIC_NR, PACK_KC};
+static const GemmLayout AVX2_LAYOUT = {"avx2-fma", AVX2_MR, AVX2_NR, PACK_KC};
+
+static bool same_layout(const GemmLayout& a, const GemmLayout& b)
+{
+    return a.isa == b.isa && a.mr == b.mr && a.nr == b.nr && a.kc == b.kc;
+}
+
+static bool cpu_has_avx2()
+{
+#if defined(DLLIB_GEMM_AVX2)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+const GemmLayout& native_gemm_layout()
+{
+    static const GemmLayout& layout = [] () -> const GemmLayout& {
+        const char* env = std::getenv("DLLIB_GEMM_ISA");
+        if (env && std::strcmp(env, "generic") == 0) {
+            return GENERIC_LAYOUT;
+        }
+        return cpu_has_avx2() ? AVX2_LAYOUT : GENERIC_LAYOUT;
+    }();
+    return layout;
+}
+
+static void check_known(const GemmLayout& layout)
+{
+    if (!same_layout(layout, GENERIC_LAYOUT) && !same_layout(layout, AVX2_LAYOUT)) {
+        throw std::invalid_argument("Unknown GEMM layout " + layout.key());
+    }
+}
+
+// Micro-kernels: C[0:rows][0:cols] += A[0:rows][0:kc] * panel, rows = R <= mr, cols <= nr
+
+typedef void (*Kernel)(int kc, const float* a, int lda, const float* panel, float* c, int ldc, int cols);
+
+// Four-float vectors of the compiler (SSE on x86-64, NEON on ARM), so the 4 x 8 block of C stays
+// in eight registers; written as plain arrays the compiler vectorizes over p instead
+typedef float Float4 __attribute__((vector_size(16)));
+
+static inline Float4 load4(const float* x)
+{
+    Float4 v;
+    std::memcpy(&v, x, sizeof(v));
+    return v;
+}
+
+template <int R>
+static void generic_kernel(int kc, const float* a, int lda, const float* panel, float* c, int ldc, int cols)
+{
+    Float4 acc0[R], acc1[R];
+    for (int r = 0; r < R; ++r) {
+        acc0[r] = Float4{};
+        acc1[r] = Float4{};
+    }
+    for (int p = 0; p < kc; ++p) {
+        Float4 b0 = load4(panel + (size_t)p * GENERIC_NR);
+        Float4 b1 = load4(panel + (size_t)p * GENERIC_NR + 4);
+        for (int r = 0; r < R; ++r) {
+            float a_rp = a[(size_t)r * lda + p];
+            acc0[r] += a_rp * b0;
+            acc1[r] += a_rp * b1;
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        float tile[GENERIC_NR];
+        std::memcpy(tile, &acc0[r], sizeof(Float4));
+        std::memcpy(tile + 4, &acc1[r], sizeof(Float4));
+        float* c_row = c + (size_t)r * ldc;
+        for (int j = 0; j < cols; ++j) {
+            c_row[j] += tile[j];
+        }
+    }
+}
+
+static const Kernel GENERIC_KERNELS[GENERIC_MR] = {
+    generic_kernel<1>, generic_kernel<2>, generic_kernel<3>, generic_kernel<4>,
+};
+
+#if defined(DLLIB_GEMM_AVX2)
+// 6 x 16 block of C in twelve ymm registers, two loads and six broadcasts per row of the panel
+template <int R>
+__attribute__((target("avx2,fma")))
+static void avx2_kernel(int kc, const float* a, int lda, const float* panel, float* c, int ldc, int cols)
+{
+    __m256 acc0[R], acc1[R];
+    for (int r = 0; r < R; ++r) {
+        acc0[r] = _mm256_setzero_ps();
+        acc1[r] = _mm256_setzero_ps();
+    }
+    for (int p = 0; p < kc; ++p) {
+        __m256 b0 = _mm256_loadu_ps(panel + (size_t)p * AVX2_NR);
+        __m256 b1 = _mm256_loadu_ps(panel + (size_t)p * AVX2_NR + 8);
+        for (int r = 0; r < R; ++r) {
+            __m256 a_rp = _mm256_broadcast_ss(a + (size_t)r * lda + p);
+            acc0[r] = _mm256_fmadd_ps(a_rp, b0, acc0[r]);
+            acc1[r] = _mm256_fmadd_ps(a_rp, b1, acc1[r]);
+        }
+    }
+    if (cols == AVX2_NR) {
+        for (int r = 0; r < R; ++r) {
+            float* c_row = c + (size_t)r * ldc;
+            _mm256_storeu_ps(c_row, _mm256_add_ps(_mm256_loadu_ps(c_row), acc0[r]));
+            _mm256_storeu_ps(c_row + 8, _mm256_add_ps(_mm256_loadu_ps(c_row + 8), acc1[r]));
+        }
+    } else {
+        // Last panel: the padded columns must not be written
+        float tile[AVX2_NR];
+        for (int r = 0; r < R; ++r) {
+            _mm256_storeu_ps(tile, acc0[r]);
+            _mm256_storeu_ps(tile + 8, acc1[r]);
+            float* c_row = c + (size_t)r * ldc;
+            for (int j = 0; j < cols; ++j) {
+                c_row[j] += tile[j];
+            }
+        }
+    }
+}
+
+static const Kernel AVX2_KERNELS[AVX2_MR] = {
+    avx2_kernel<1>, avx2_kernel<2>, avx2_kernel<3>, avx2_kernel<4>, avx2_kernel<5>, avx2_kernel<6>,
+};
+#endif
+
+static const Kernel* kernels_for(const GemmLayout& layout)
+{
+    if (same_layout(layout, GENERIC_LAYOUT)) {
+        return GENERIC_KERNELS;
+    }
+#if defined(DLLIB_GEMM_AVX2)
+    if (same_layout(layout, AVX2_LAYOUT) && cpu_has_avx2()) {
+        return AVX2_KERNELS;
+    }
+#endif
+    throw std::invalid_argument("This CPU cannot run GEMM layout " + layout.key());
+}
+
+// Packed matrices
+
+static size_t padded_cols(int n, const GemmLayout& layout)
+{
+    return ((size_t)n + layout.nr - 1) / layout.nr * layout.nr;
+}
+
+size_t PackedMatrix::packed_floats(int k, int n, const GemmLayout& layout)
+{
+    return (size_t)k * padded_cols(n, layout);
+}
+
+PackedMatrix::PackedMatrix(const float* b, int k, int n, int ldb, const GemmLayout& layout)
+    : k_(k), n_(n), layout_(layout)
+{
+    check_known(layout);
+    if (k <= 0 || n <= 0 || ldb < n) {
+        throw std::invalid_argument("Matrix dimensions must be positive and ldb at least n.");
+    }
+    owned_.resize(packed_floats(k, n, layout));
+    size_t padded = padded_cols(n, layout);
+    for (int p0 = 0; p0 < k; p0 += layout.kc) {
+        int depth = std::min(layout.kc, k - p0);
+        float* block = owned_.data() + (size_t)p0 * padded;
+        for (int j0 = 0; j0 < n; j0 += layout.nr) {
+            float* panel = block + (size_t)j0 * depth;
+            int cols = std::min(layout.nr, n - j0);
+            for (int p = 0; p < depth; ++p) {
+                const float* b_row = b + (size_t)(p0 + p) * ldb + j0;
+                float* panel_row = panel + (size_t)p * layout.nr;
+                std::copy(b_row, b_row + cols, panel_row);
+                std::fill(panel_row + cols, panel_row + layout.nr, 0.0f);
+            }
+        }
+    }
+}
+
+PackedMatrix PackedMatrix::borrow(const float* data, int k, int n, const GemmLayout& layout)
+{
+    check_known(layout);
+    if (k <= 0 || n <= 0 || !data) {
+        throw std::invalid_argument("Matrix dimensions must be positive and data not null.");
+    }
+    PackedMatrix matrix;
+    matrix.borrowed_ = data;
+    matrix.k_ = k;
+    matrix.n_ = n;
+    matrix.layout_ = layout;
+    return matrix;
+}
+
+void gemm_packed(int m, const float* a, int lda, const PackedMatrix& b, float beta, float* c, int ldc)
+{
+    const GemmLayout& layout = b.layout();
+    int k = b.rows(), n = b.cols();
+    if (m < 0) {
+        throw std::invalid_argument("Matrix dimensions must be non-negative.");
+    }
+    if (m == 0 || n == 0) return;
+    const Kernel* kernels = kernels_for(layout);
+
+    // C = beta * C, as in gemm()
+    for (int i = 0; i < m; ++i) {
+        float* c_row = c + (size_t)i * ldc;
+        if (beta == 0.0f) {
+            std::fill(c_row, c_row + n, 0.0f);
+        } else if (beta != 1.0f) {
+            for (int j = 0; j < n; ++j) c_row[j] *= beta;
+        }
+    }
+
+    size_t padded = padded_cols(n, layout);
+    const float* packed = b.data();
+    for (int p0 = 0; p0 < k; p0 += layout.kc) {
+        int depth = std::min(layout.kc, k - p0);
+        const float* block = packed + (size_t)p0 * padded;
+        for (int j0 = 0; j0 < n; j0 += layout.nr) {
+            const float* panel = block + (size_t)j0 * depth;
+            int cols = std::min(layout.nr, n - j0);
+            for (int i0 = 0; i0 < m; i0 += layout.mr) {
+                int rows = std::min(layout.mr, m - i0);
+                kernels[rows - 1](depth, a + (size_t)i0 * lda + p0, lda, panel, c + (size_t)i0 * ldc + j0, ldc, cols);
+            }
+        }
+    }
+}
+
+// Cache file
+
+static const uint64_t CACHE_VERSION = 1;
+static const char* STAMP_NAME = "packed.stamp";
+// Cache version, model file size and modification time (s, ns), as 8 int32
+static const size_t STAMP_INTS = 8;
+
+// Size and modification time of the mapped model, not of model_path: if the path is renamed over
+// after the model was opened, the cache packed from the old mapping is stamped as the old file
+// and the next start, opening the new one, repacks
+static std::vector<int32_t> model_stamp(const WeightFile& model)
+{
+    uint64_t values[4] = {CACHE_VERSION, (uint64_t)model.file_bytes(), (uint64_t)(model.modified_ns() / 1000000000),
+                          (uint64_t)(model.modified_ns() % 1000000000)};
+    std::vector<int32_t> stamp(STAMP_INTS);
+    std::memcpy(stamp.data(), values, sizeof(values));
+    return stamp;
+}
+
+static bool is_matrix(const WeightTensor& tensor)
+{
+    return tensor.type == TensorType::Float32 && tensor.shape.size() == 2 &&
+           tensor.shape[0] <= (size_t)INT32_MAX && tensor.shape[1] <= (size_t)INT32_MAX;
+}
+
+PackedWeightCache::PackedWeightCache(const WeightFile& model, const std::string& model_path, const GemmLayout& layout)
+    : path_(model_path + "." + layout.key() + ".packed")
+{
+    check_known(layout);
+    std::vector<int32_t> stamp = model_stamp(model);
+
+    // Map the cache if it matches the model, otherwise fall through to packing
+    try {
+        std::unique_ptr<WeightFile> cache(new WeightFile(path_));
+        const int32_t* cached_stamp = cache->int32s(STAMP_NAME, {STAMP_INTS});
+        if (std::equal(stamp.begin(), stamp.end(), cached_stamp)) {
+            std::unordered_map<std::string, PackedMatrix> matrices;
+            for (size_t t = 0; t < model.size(); ++t) {
+                const WeightTensor& tensor = model.tensor(t);
+                if (!is_matrix(tensor)) continue;
+                int k = (int)tensor.shape[0], n = (int)tensor.shape[1];
+                const float* data = cache->floats(tensor.name, {PackedMatrix::packed_floats(k, n, layout)});
+                matrices.emplace(tensor.name, PackedMatrix::borrow(data, k, n, layout));
+            }
+            matrices_ = std::move(matrices);
+            file_ = std::move(cache);
+            loaded_from_disk_ = true;
+            return;
+        }
+    } catch (const std::exception&) {
+        // Missing, stale or damaged cache
+    }
+
+    WeightFileWriter writer;
+    for (size_t t = 0; t < model.size(); ++t) {
+        const WeightTensor& tensor = model.tensor(t);
+        if (!is_matrix(tensor)) continue;
+        int k = (int)tensor.shape[0], n = (int)tensor.shape[1];
+        PackedMatrix packed(static_cast<const float*>(tensor.data), k, n, n, layout);
+        const PackedMatrix& stored = matrices_.emplace(tensor.name, std::move(packed)).first->second;
+        writer.add(tensor.name, stored.data(), {stored.size()});
+    }
+    writer.add(STAMP_NAME, stamp.data(), {STAMP_INTS});
+    try {
+        writer.write(path_);
+    } catch (const std::runtime_error&) {
+        // Read-only model directory: keep the packed copies in memory
+        return;
+    }
+
+    // Serve from the mapping like the next starts will, and release the packed copies
+    std::unique_ptr<WeightFile> cache(new WeightFile(path_));
+    for (auto& entry : matrices_) {
+        const float* data = cache->floats(entry.first, {entry.second.size()});
+        entry.second = PackedMatrix::borrow(data, entry.second.rows(), entry.second.cols(), layout);
+    }
+    file_ = std::move(cache);
+}
+
+const PackedMatrix& PackedWeightCache::matrix(const std::string& name) const
+{
+    auto found = matrices_.find(name);
+    if (found == matrices_.end()) {
+        throw std::out_of_range("The model has no matrix " + name);
+    }
+    return found->second;
+}
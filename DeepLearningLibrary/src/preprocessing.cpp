@@ -8,9 +8,105 @@
 #include <iostream>
 #include <vector>
 #include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "../headers/preprocessing.h"
+#include "../headers/thread_pool.h"
 
 float mean(std::vector<float> vec)
 {
-    float sum_of_elems = std::accumulate(vec.begin(), vec.end(), 0);
+    float sum_of_elems = parallel_reduce(0, vec.size(), ELEMENTWISE_GRAIN, 0.0f, [&](size_t begin, size_t end) {
+        return std::accumulate(vec.begin() + begin, vec.begin() + end, 0.0f);
+    }, [](float a, float b) { return a + b; });
     return sum_of_elems/vec.size();
 }
+
+void RunningStats::update(const float* x, size_t n)
+{
+    if (n == 0) {
+        return;
+    }
+    // Mean and squared deviations of the batch, then merged with the totals so far
+    double batch_sum = 0.0;
+    float batch_min = x[0], batch_max = x[0];
+    for (size_t i = 0; i < n; ++i) {
+        batch_sum += x[i];
+        batch_min = std::min(batch_min, x[i]);
+        batch_max = std::max(batch_max, x[i]);
+    }
+    double batch_mean = batch_sum / n;
+    double batch_m2 = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double d = x[i] - batch_mean;
+        batch_m2 += d * d;
+    }
+
+    if (count_ == 0) {
+        min_ = batch_min;
+        max_ = batch_max;
+    } else {
+        min_ = std::min(min_, batch_min);
+        max_ = std::max(max_, batch_max);
+    }
+    size_t total = count_ + n;
+    double delta = batch_mean - mean_;
+    mean_ += delta * n / total;
+    m2_ += batch_m2 + delta * delta * ((double)count_ * n / total);
+    count_ = total;
+}
+
+StreamingHistogram::StreamingHistogram(int bins)
+{
+    if (bins < 2 || bins % 2 != 0) {
+        throw std::invalid_argument("The number of histogram bins must be even and at least 2.");
+    }
+    counts_.assign(bins, 0);
+}
+
+void StreamingHistogram::update(const float* x, size_t n)
+{
+    float batch_max = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        batch_max = std::max(batch_max, std::fabs(x[i]));
+    }
+    if (!std::isfinite(batch_max)) {
+        throw std::invalid_argument("Histogram values must be finite.");
+    }
+    if (limit_ == 0.0f) {
+        // Until a nonzero value arrives the limit stays 0 and every value is counted in bin 0
+        limit_ = batch_max;
+    }
+    while (batch_max > limit_) {
+        size_t half = counts_.size() / 2;
+        for (size_t i = 0; i < half; ++i) {
+            counts_[i] = counts_[2 * i] + counts_[2 * i + 1];
+        }
+        std::fill(counts_.begin() + half, counts_.end(), 0);
+        limit_ *= 2.0f;
+    }
+
+    int last = bins() - 1;
+    float inv_width = limit_ > 0.0f ? counts_.size() / limit_ : 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        int bin = (int)(std::fabs(x[i]) * inv_width);
+        ++counts_[std::min(bin, last)];
+    }
+    total_ += n;
+}
+
+float StreamingHistogram::percentile(float percent) const
+{
+    if (!(percent > 0.0f && percent <= 100.0f)) {
+        throw std::invalid_argument("Percentile must be in (0, 100].");
+    }
+    double target = total_ * (percent / 100.0);
+    uint64_t cumulative = 0;
+    for (int i = 0; i < bins(); ++i) {
+        cumulative += counts_[i];
+        if (cumulative >= target) {
+            return (i + 1) * bin_width();
+        }
+    }
+    return limit_;
+}
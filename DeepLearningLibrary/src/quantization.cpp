@@ -0,0 +1,310 @@
+//
+//  quantization.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Conversions between float and affine int8 buffers, and the int8 dense layer.
+//  QuantizedDense computes, for each row and channel o,
+//    acc = sum_i (x_i + 128) * w_io                       (int32, the kernels)
+//    y   = clamp(lrint((acc + offset_o) * multiplier_o) + output zero point, lo, hi)
+//  offset_o = round(b_o / (s_x * s_o)) - (128 + zp_x) * sum_i w_io turns acc into
+//  sum_i (x_i - zp_x) * w_io + quantized bias, whose real value is s_x * s_o times that.
+//  A kernel call computes up to R rows x 16 channels; the epilogue requantizes those 16
+//  accumulators right away, from registers, before the next block.
+//  The AVX-512 and AVX2 kernels are compiled with target attributes and chosen at run time,
+//  as in packed_gemm.cpp.
+//
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "../headers/quantization.h"
+#include "../headers/network.h"
+#include "../headers/thread_pool.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DLLIB_INT8_X86 1
+#endif
+
+std::vector<int8_t> quantize(const std::vector<float>& x, const QuantParams& params)
+{
+    std::vector<int8_t> q(x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        q[i] = quantize(x[i], params);
+    }
+    return q;
+}
+
+std::vector<float> dequantize(const std::vector<int8_t>& q, const QuantParams& params)
+{
+    std::vector<float> x(q.size());
+    for (size_t i = 0; i < q.size(); ++i) {
+        x[i] = dequantize(q[i], params);
+    }
+    return x;
+}
+
+// Int8 dense layer
+
+// Output channels per packed block, one zmm of int32 accumulators
+static const int INT8_BLOCK = 16;
+// Flips the sign bit of 4 packed int8, x + 128 as unsigned bytes
+static const uint32_t SIGN_FLIP = 0x80808080u;
+
+// acc[r][0:16] = sum over the groups of (x[r] + 128) * w for rows r < R of one block of 16 channels
+typedef void (*Int8Kernel)(const int8_t* x, size_t ldx, int in, const int8_t* w, int32_t* acc);
+
+// 4 inputs of a row starting at 4 * g; the last group of a row whose length is not a multiple of
+// 4 is completed with zeros (their weights are 0)
+static inline uint32_t load_group(const int8_t* row, int g, int in)
+{
+    uint32_t x4 = 0;
+    if (4 * g + 4 <= in) {
+        std::memcpy(&x4, row + 4 * g, 4);
+    } else {
+        std::memcpy(&x4, row + 4 * g, in - 4 * g);
+    }
+    return x4;
+}
+
+template <int R>
+static void generic_kernel(const int8_t* x, size_t ldx, int in, const int8_t* w, int32_t* acc)
+{
+    int groups = (in + 3) / 4;
+    for (int r = 0; r < R; ++r) {
+        int32_t sum[INT8_BLOCK] = {};
+        const int8_t* row = x + (size_t)r * ldx;
+        for (int g = 0; g < groups; ++g) {
+            uint8_t x_u[4];
+            uint32_t x4 = load_group(row, g, in) ^ SIGN_FLIP;
+            std::memcpy(x_u, &x4, 4);
+            const int8_t* w_g = w + (size_t)g * INT8_BLOCK * 4;
+            for (int j = 0; j < INT8_BLOCK; ++j) {
+                for (int t = 0; t < 4; ++t) {
+                    sum[j] += (int32_t)x_u[t] * w_g[j * 4 + t];
+                }
+            }
+        }
+        std::memcpy(acc + r * INT8_BLOCK, sum, sizeof(sum));
+    }
+}
+
+#if defined(DLLIB_INT8_X86)
+// One vpdpbusd per row and group: 16 channels x 4 inputs. With fewer than 4 rows each row keeps
+// several independent sums (over alternating groups) to hide the latency of the instruction.
+template <int R>
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static void vnni_kernel(const int8_t* x, size_t ldx, int in, const int8_t* w, int32_t* acc)
+{
+    constexpr int U = R >= 4 ? 1 : 4 / R;
+    __m512i sum[R][U];
+    for (int r = 0; r < R; ++r) {
+        for (int u = 0; u < U; ++u) {
+            sum[r][u] = _mm512_setzero_si512();
+        }
+    }
+    int groups = (in + 3) / 4;
+    int full = in / 4 / U * U;
+    for (int g = 0; g < full; g += U) {
+        for (int u = 0; u < U; ++u) {
+            __m512i w_g = _mm512_loadu_si512(w + (size_t)(g + u) * INT8_BLOCK * 4);
+            for (int r = 0; r < R; ++r) {
+                uint32_t x4;
+                std::memcpy(&x4, x + (size_t)r * ldx + 4 * (g + u), 4);
+                sum[r][u] = _mm512_dpbusd_epi32(sum[r][u], _mm512_set1_epi32((int)(x4 ^ SIGN_FLIP)), w_g);
+            }
+        }
+    }
+    for (int g = full; g < groups; ++g) {
+        __m512i w_g = _mm512_loadu_si512(w + (size_t)g * INT8_BLOCK * 4);
+        for (int r = 0; r < R; ++r) {
+            uint32_t x4 = load_group(x + (size_t)r * ldx, g, in);
+            sum[r][0] = _mm512_dpbusd_epi32(sum[r][0], _mm512_set1_epi32((int)(x4 ^ SIGN_FLIP)), w_g);
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        for (int u = 1; u < U; ++u) {
+            sum[r][0] = _mm512_add_epi32(sum[r][0], sum[r][u]);
+        }
+        _mm512_storeu_si512(acc + r * INT8_BLOCK, sum[r][0]);
+    }
+}
+
+// Without VNNI: the 64 weight bytes of a group are widened to four vectors of 16 int16 (4
+// channels x 4 inputs each) and multiplied with the 4 activations by vpmaddwd, which adds pairs
+// of products into int32. That leaves two partial sums per channel, added once at the end.
+// Exact, unlike vpmaddubsw whose 16-bit pair sums saturate.
+template <int R>
+__attribute__((target("avx2")))
+static void avx2_kernel(const int8_t* x, size_t ldx, int in, const int8_t* w, int32_t* acc)
+{
+    __m256i sum[R][4];
+    for (int r = 0; r < R; ++r) {
+        for (int q = 0; q < 4; ++q) {
+            sum[r][q] = _mm256_setzero_si256();
+        }
+    }
+    int groups = (in + 3) / 4;
+    for (int g = 0; g < groups; ++g) {
+        const int8_t* w_g = w + (size_t)g * INT8_BLOCK * 4;
+        __m256i w16[4];
+        for (int q = 0; q < 4; ++q) {
+            w16[q] = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(w_g + 16 * q)));
+        }
+        for (int r = 0; r < R; ++r) {
+            uint32_t x4 = load_group(x + (size_t)r * ldx, g, in) ^ SIGN_FLIP;
+            __m256i x16 = _mm256_cvtepu8_epi16(_mm_set1_epi32((int)x4));
+            for (int q = 0; q < 4; ++q) {
+                sum[r][q] = _mm256_add_epi32(sum[r][q], _mm256_madd_epi16(x16, w16[q]));
+            }
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        // sum[q] holds two halves of channels 4q..4q+3 as [c0 c0 c1 c1 | c2 c2 c3 c3];
+        // hadd gives [c0 c1 c4 c5 | c2 c3 c6 c7], the permute puts the channels in order
+        __m256i low = _mm256_permute4x64_epi64(_mm256_hadd_epi32(sum[r][0], sum[r][1]), 0xD8);
+        __m256i high = _mm256_permute4x64_epi64(_mm256_hadd_epi32(sum[r][2], sum[r][3]), 0xD8);
+        _mm256_storeu_si256((__m256i*)(acc + r * INT8_BLOCK), low);
+        _mm256_storeu_si256((__m256i*)(acc + r * INT8_BLOCK + 8), high);
+    }
+}
+#endif
+
+struct Int8Kernels {
+    const char* name;
+    int max_rows;
+    Int8Kernel kernels[4];
+};
+
+static const Int8Kernels GENERIC_INT8 = {"generic", 1, {generic_kernel<1>}};
+#if defined(DLLIB_INT8_X86)
+static const Int8Kernels VNNI_INT8 = {"avx512-vnni", 4, {vnni_kernel<1>, vnni_kernel<2>, vnni_kernel<3>, vnni_kernel<4>}};
+static const Int8Kernels AVX2_INT8 = {"avx2", 2, {avx2_kernel<1>, avx2_kernel<2>}};
+#endif
+
+static const Int8Kernels& int8_kernels()
+{
+    static const Int8Kernels& kernels = [] () -> const Int8Kernels& {
+        const char* env = std::getenv("DLLIB_INT8_ISA");
+        std::string forced = env ? env : "";
+        if (forced == "generic") {
+            return GENERIC_INT8;
+        }
+#if defined(DLLIB_INT8_X86)
+        if (forced != "avx2" && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512vnni")) {
+            return VNNI_INT8;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return AVX2_INT8;
+        }
+#endif
+        return GENERIC_INT8;
+    }();
+    return kernels;
+}
+
+const char* int8_kernel()
+{
+    return int8_kernels().name;
+}
+
+QuantizedDense::QuantizedDense(const Dense& layer, const QuantParams& input_params, const QuantParams& output_params)
+    : in_features_(layer.in_features), out_features_(layer.out_features),
+      input_params_(input_params), output_params_(output_params)
+{
+    if (layer.activation != Activation::Identity && layer.activation != Activation::ReLU &&
+        layer.activation != Activation::ReLU6) {
+        throw std::invalid_argument("Only Identity, ReLU and ReLU6 can be fused into an int8 layer.");
+    }
+    if (!(input_params.scale > 0.0f) || !(output_params.scale > 0.0f)) {
+        throw std::invalid_argument("Quantization scales must be positive.");
+    }
+
+    int blocks = (out_features_ + INT8_BLOCK - 1) / INT8_BLOCK;
+    int groups = (in_features_ + 3) / 4;
+    packed_weights_.assign((size_t)blocks * groups * INT8_BLOCK * 4, 0);
+    weight_scales_.resize(out_features_);
+    offsets_.assign((size_t)blocks * INT8_BLOCK, 0);
+    multipliers_.assign((size_t)blocks * INT8_BLOCK, 0.0f);
+
+    for (int o = 0; o < out_features_; ++o) {
+        float max_abs = 0.0f;
+        for (int i = 0; i < in_features_; ++i) {
+            max_abs = std::max(max_abs, std::fabs(layer.weights[(size_t)i * out_features_ + o]));
+        }
+        float scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+        weight_scales_[o] = scale;
+
+        int block = o / INT8_BLOCK, j = o % INT8_BLOCK;
+        int32_t weight_sum = 0;
+        for (int i = 0; i < in_features_; ++i) {
+            int q = (int)std::lrintf(layer.weights[(size_t)i * out_features_ + o] / scale);
+            q = std::min(127, std::max(-127, q));
+            weight_sum += q;
+            size_t at = (((size_t)block * groups + i / 4) * INT8_BLOCK + j) * 4 + i % 4;
+            packed_weights_[at] = (int8_t)q;
+        }
+        float accumulator_scale = input_params.scale * scale;
+        int32_t bias = (int32_t)std::lrintf(layer.bias[o] / accumulator_scale);
+        offsets_[o] = bias - (128 + input_params.zero_point) * weight_sum;
+        multipliers_[o] = accumulator_scale / output_params.scale;
+    }
+
+    lo_ = -128;
+    hi_ = 127;
+    if (layer.activation != Activation::Identity) {
+        lo_ = quantize(0.0f, output_params);
+    }
+    if (layer.activation == Activation::ReLU6) {
+        hi_ = quantize(6.0f, output_params);
+    }
+}
+
+void QuantizedDense::forward(const int8_t* input, int8_t* output, int batch) const
+{
+    if (batch < 0) {
+        throw std::invalid_argument("Batch size must be non-negative.");
+    }
+    const Int8Kernels& kernels = int8_kernels();
+    int blocks = (out_features_ + INT8_BLOCK - 1) / INT8_BLOCK;
+    size_t block_bytes = (size_t)((in_features_ + 3) / 4) * INT8_BLOCK * 4;
+    // Rows per chunk: about ELEMENTWISE_GRAIN multiply-adds per row block and channel block
+    size_t rows_per_chunk = std::max<size_t>(kernels.max_rows,
+                                             ELEMENTWISE_GRAIN / ((size_t)in_features_ * out_features_ / kernels.max_rows + 1));
+    int zero_point = output_params_.zero_point;
+
+    parallel_for(0, batch, rows_per_chunk, [&](size_t row_begin, size_t row_end) {
+        int32_t acc[4 * INT8_BLOCK];
+        for (size_t r0 = row_begin; r0 < row_end; r0 += kernels.max_rows) {
+            int rows = (int)std::min<size_t>(kernels.max_rows, row_end - r0);
+            const int8_t* x = input + r0 * in_features_;
+            for (int block = 0; block < blocks; ++block) {
+                kernels.kernels[rows - 1](x, in_features_, in_features_, packed_weights_.data() + block * block_bytes, acc);
+
+                // Requantize the 16 channels of the block, the activation is the clamp
+                int c0 = block * INT8_BLOCK;
+                int channels = std::min(INT8_BLOCK, out_features_ - c0);
+                const int32_t* offset = offsets_.data() + c0;
+                const float* multiplier = multipliers_.data() + c0;
+                for (int r = 0; r < rows; ++r) {
+                    int8_t* y = output + (r0 + r) * out_features_ + c0;
+                    const int32_t* a = acc + r * INT8_BLOCK;
+                    for (int j = 0; j < channels; ++j) {
+                        int q = (int)std::lrintf((float)(a[j] + offset[j]) * multiplier[j]) + zero_point;
+                        y[j] = (int8_t)std::min<int>(hi_, std::max<int>(lo_, q));
+                    }
+                }
+            }
+        }
+    });
+}
+
+void QuantizedDense::forward(const std::vector<int8_t>& input, std::vector<int8_t>& output, int batch) const
+{
+    if (input.size() != (size_t)batch * in_features_) {
+        throw std::invalid_argument("Input size does not match batch * in_features.");
+    }
+    output.resize((size_t)batch * out_features_);
+    forward(input.data(), output.data(), batch);
+}
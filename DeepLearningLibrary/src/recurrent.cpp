@@ -0,0 +1,304 @@
+//
+//  recurrent.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  LSTM and GRU cells.
+//  The gate pre-activations of a step come out of a single GEMM over the concatenated gate weights,
+//  then one fused pass per row applies sigmoid/tanh and the state update, so the gates are never
+//  written out and read back between separate activation calls. The activations use the
+//  branch-free approximations of vector_math.h so that pass vectorizes.
+//  The backward step reuses the saved (activated) gates: the sigmoid and tanh derivatives are
+//  computed from their outputs, as in activation_funcs_gradient.cpp.
+//
+#include <cmath>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include "../headers/recurrent.h"
+#include "../headers/linalg.h"
+#include "../headers/vector_math.h"
+
+// U(-1/sqrt(hidden), 1/sqrt(hidden)), the usual initialization of recurrent cells
+static void init_uniform(std::vector<float>& w, int hidden_size, std::mt19937& gen)
+{
+    float limit = 1.0f / std::sqrt((float)hidden_size);
+    std::uniform_real_distribution<float> dist(-limit, limit);
+    for (float& v : w) {
+        v = dist(gen);
+    }
+}
+
+static void check_size(const std::vector<float>& v, size_t expected, const char* what)
+{
+    if (v.size() != expected) {
+        throw std::invalid_argument(std::string(what) + " has the wrong size.");
+    }
+}
+
+// Sum of the rows of a batch x n matrix, accumulated into out
+static void accumulate_rows(const float* m, int batch, int n, float* out)
+{
+    for (int b = 0; b < batch; ++b) {
+        const float* row = m + (size_t)b * n;
+        for (int j = 0; j < n; ++j) {
+            out[j] += row[j];
+        }
+    }
+}
+
+// Elements of a cell's first weight matrix, rows x (gates * hidden_size). Called in the member
+// initializers, so that bad sizes throw std::invalid_argument before anything is allocated.
+static size_t checked_size(int input_size, int hidden_size, int rows, int gates)
+{
+    if (input_size <= 0 || hidden_size <= 0) {
+        throw std::invalid_argument("Cell sizes must be positive.");
+    }
+    return (size_t)rows * gates * hidden_size;
+}
+
+// LSTM
+
+LSTMCell::LSTMCell(int input_size, int hidden_size, unsigned seed)
+    : input_size(input_size), hidden_size(hidden_size),
+      weights(checked_size(input_size, hidden_size, input_size + hidden_size, 4)),
+      bias(4 * (size_t)hidden_size, 0.0f),
+      grad_weights(weights.size(), 0.0f), grad_bias(bias.size(), 0.0f)
+{
+    std::mt19937 gen(seed);
+    init_uniform(weights, hidden_size, gen);
+    // Forget gate bias of 1 so the cell remembers by default early in training
+    std::fill(bias.begin() + hidden_size, bias.begin() + 2 * hidden_size, 1.0f);
+}
+
+void LSTMCell::forward(const std::vector<float>& x, const std::vector<float>& h_prev, const std::vector<float>& c_prev,
+                       std::vector<float>& h, std::vector<float>& c, int batch, LSTMStepCache* cache) const
+{
+    const int H = hidden_size, I = input_size, K = I + H;
+    check_size(x, (size_t)batch * I, "Input");
+    check_size(h_prev, (size_t)batch * H, "Hidden state");
+    check_size(c_prev, (size_t)batch * H, "Cell state");
+
+    LSTMStepCache local;
+    LSTMStepCache& saved = cache ? *cache : local;
+    saved.xh.resize((size_t)batch * K);
+    for (int b = 0; b < batch; ++b) {
+        std::copy(x.begin() + (size_t)b * I, x.begin() + (size_t)(b + 1) * I, saved.xh.begin() + (size_t)b * K);
+        std::copy(h_prev.begin() + (size_t)b * H, h_prev.begin() + (size_t)(b + 1) * H, saved.xh.begin() + (size_t)b * K + I);
+    }
+
+    std::vector<float>& gates = saved.gates;
+    gates.resize((size_t)batch * 4 * H);
+    for (int b = 0; b < batch; ++b) {
+        std::copy(bias.begin(), bias.end(), gates.begin() + (size_t)b * 4 * H);
+    }
+    gemm(false, false, batch, 4 * H, K, 1.0f, saved.xh.data(), K, weights.data(), 4 * H, 1.0f, gates.data(), 4 * H);
+
+    h.resize((size_t)batch * H);
+    c.resize((size_t)batch * H);
+    if (cache) {
+        saved.c_prev = c_prev;
+        saved.tanh_c.resize((size_t)batch * H);
+    }
+    // Fused gate activations and state update
+    for (int b = 0; b < batch; ++b) {
+        float* i_g = gates.data() + (size_t)b * 4 * H;
+        float* f_g = i_g + H;
+        float* g_g = i_g + 2 * H;
+        float* o_g = i_g + 3 * H;
+        const float* cp = c_prev.data() + (size_t)b * H;
+        float* c_row = c.data() + (size_t)b * H;
+        float* h_row = h.data() + (size_t)b * H;
+        float* tc_row = cache ? saved.tanh_c.data() + (size_t)b * H : h_row;
+        for (int j = 0; j < H; ++j) {
+            float i = fast_sigmoid(i_g[j]);
+            float f = fast_sigmoid(f_g[j]);
+            float g = fast_tanh(g_g[j]);
+            float o = fast_sigmoid(o_g[j]);
+            float cn = f * cp[j] + i * g;
+            float tc = fast_tanh(cn);
+            i_g[j] = i;
+            f_g[j] = f;
+            g_g[j] = g;
+            o_g[j] = o;
+            c_row[j] = cn;
+            tc_row[j] = tc;
+            h_row[j] = o * tc;
+        }
+    }
+}
+
+void LSTMCell::backward(const LSTMStepCache& cache, std::vector<float>& grad_h, std::vector<float>& grad_c,
+                        std::vector<float>& grad_x, int batch)
+{
+    const int H = hidden_size, I = input_size, K = I + H;
+    check_size(grad_h, (size_t)batch * H, "Hidden state gradient");
+    check_size(grad_c, (size_t)batch * H, "Cell state gradient");
+    check_size(cache.gates, (size_t)batch * 4 * H, "Saved gates");
+
+    // Gradients of the gate pre-activations, from the saved activated gates
+    std::vector<float> grad_gates((size_t)batch * 4 * H);
+    for (int b = 0; b < batch; ++b) {
+        const float* i_g = cache.gates.data() + (size_t)b * 4 * H;
+        const float* f_g = i_g + H;
+        const float* g_g = i_g + 2 * H;
+        const float* o_g = i_g + 3 * H;
+        const float* cp = cache.c_prev.data() + (size_t)b * H;
+        const float* tc = cache.tanh_c.data() + (size_t)b * H;
+        float* dh = grad_h.data() + (size_t)b * H;
+        float* dc = grad_c.data() + (size_t)b * H;
+        float* di = grad_gates.data() + (size_t)b * 4 * H;
+        float* df = di + H;
+        float* dg = di + 2 * H;
+        float* d_o = di + 3 * H;
+        for (int j = 0; j < H; ++j) {
+            float dct = dc[j] + dh[j] * o_g[j] * (1.0f - tc[j] * tc[j]);
+            d_o[j] = dh[j] * tc[j] * o_g[j] * (1.0f - o_g[j]);
+            di[j] = dct * g_g[j] * i_g[j] * (1.0f - i_g[j]);
+            df[j] = dct * cp[j] * f_g[j] * (1.0f - f_g[j]);
+            dg[j] = dct * i_g[j] * (1.0f - g_g[j] * g_g[j]);
+            dc[j] = dct * f_g[j];
+        }
+    }
+
+    accumulate_rows(grad_gates.data(), batch, 4 * H, grad_bias.data());
+    gemm(true, false, K, 4 * H, batch, 1.0f, cache.xh.data(), K, grad_gates.data(), 4 * H,
+         1.0f, grad_weights.data(), 4 * H);
+
+    // d[x, h_prev] = dGates * W^T, split back into dx and dh_prev
+    std::vector<float> grad_xh((size_t)batch * K);
+    gemm(false, true, batch, K, 4 * H, 1.0f, grad_gates.data(), 4 * H, weights.data(), 4 * H,
+         0.0f, grad_xh.data(), K);
+    grad_x.resize((size_t)batch * I);
+    for (int b = 0; b < batch; ++b) {
+        const float* row = grad_xh.data() + (size_t)b * K;
+        std::copy(row, row + I, grad_x.begin() + (size_t)b * I);
+        std::copy(row + I, row + K, grad_h.begin() + (size_t)b * H);
+    }
+}
+
+void LSTMCell::zero_grad()
+{
+    std::fill(grad_weights.begin(), grad_weights.end(), 0.0f);
+    std::fill(grad_bias.begin(), grad_bias.end(), 0.0f);
+}
+
+// GRU
+
+GRUCell::GRUCell(int input_size, int hidden_size, unsigned seed)
+    : input_size(input_size), hidden_size(hidden_size),
+      weights_x(checked_size(input_size, hidden_size, input_size, 3)), weights_h((size_t)hidden_size * 3 * hidden_size),
+      bias_x(3 * (size_t)hidden_size, 0.0f), bias_h(3 * (size_t)hidden_size, 0.0f),
+      grad_weights_x(weights_x.size(), 0.0f), grad_weights_h(weights_h.size(), 0.0f),
+      grad_bias_x(bias_x.size(), 0.0f), grad_bias_h(bias_h.size(), 0.0f)
+{
+    std::mt19937 gen(seed);
+    init_uniform(weights_x, hidden_size, gen);
+    init_uniform(weights_h, hidden_size, gen);
+}
+
+void GRUCell::forward(const std::vector<float>& x, const std::vector<float>& h_prev,
+                      std::vector<float>& h, int batch, GRUStepCache* cache) const
+{
+    const int H = hidden_size, I = input_size;
+    check_size(x, (size_t)batch * I, "Input");
+    check_size(h_prev, (size_t)batch * H, "Hidden state");
+
+    GRUStepCache local;
+    GRUStepCache& saved = cache ? *cache : local;
+    std::vector<float>& gates = saved.gates;
+    gates.resize((size_t)batch * 3 * H);
+    std::vector<float> hidden((size_t)batch * 3 * H);
+    for (int b = 0; b < batch; ++b) {
+        std::copy(bias_x.begin(), bias_x.end(), gates.begin() + (size_t)b * 3 * H);
+        std::copy(bias_h.begin(), bias_h.end(), hidden.begin() + (size_t)b * 3 * H);
+    }
+    gemm(false, false, batch, 3 * H, I, 1.0f, x.data(), I, weights_x.data(), 3 * H, 1.0f, gates.data(), 3 * H);
+    gemm(false, false, batch, 3 * H, H, 1.0f, h_prev.data(), H, weights_h.data(), 3 * H, 1.0f, hidden.data(), 3 * H);
+
+    h.resize((size_t)batch * H);
+    if (cache) {
+        saved.x = x;
+        saved.h_prev = h_prev;
+        saved.hn.resize((size_t)batch * H);
+    }
+    // Fused gate activations and state update
+    for (int b = 0; b < batch; ++b) {
+        float* r_g = gates.data() + (size_t)b * 3 * H;
+        float* z_g = r_g + H;
+        float* n_g = r_g + 2 * H;
+        const float* hr = hidden.data() + (size_t)b * 3 * H;
+        const float* hz = hr + H;
+        const float* hn = hr + 2 * H;
+        const float* hp = h_prev.data() + (size_t)b * H;
+        float* h_row = h.data() + (size_t)b * H;
+        for (int j = 0; j < H; ++j) {
+            float r = fast_sigmoid(r_g[j] + hr[j]);
+            float z = fast_sigmoid(z_g[j] + hz[j]);
+            float n = fast_tanh(n_g[j] + r * hn[j]);
+            r_g[j] = r;
+            z_g[j] = z;
+            n_g[j] = n;
+            h_row[j] = (1.0f - z) * n + z * hp[j];
+        }
+        if (cache) {
+            std::copy(hn, hn + H, saved.hn.begin() + (size_t)b * H);
+        }
+    }
+}
+
+void GRUCell::backward(const GRUStepCache& cache, std::vector<float>& grad_h, std::vector<float>& grad_x, int batch)
+{
+    const int H = hidden_size, I = input_size;
+    check_size(grad_h, (size_t)batch * H, "Hidden state gradient");
+    check_size(cache.gates, (size_t)batch * 3 * H, "Saved gates");
+
+    // grad_in: gradients of x * W_x + b_x, grad_hid: gradients of h_prev * W_h + b_h.
+    // They only differ in the candidate part, which the reset gate scales on the recurrent side.
+    std::vector<float> grad_in((size_t)batch * 3 * H);
+    std::vector<float> grad_hid((size_t)batch * 3 * H);
+    for (int b = 0; b < batch; ++b) {
+        const float* r_g = cache.gates.data() + (size_t)b * 3 * H;
+        const float* z_g = r_g + H;
+        const float* n_g = r_g + 2 * H;
+        const float* hn = cache.hn.data() + (size_t)b * H;
+        const float* hp = cache.h_prev.data() + (size_t)b * H;
+        float* dh = grad_h.data() + (size_t)b * H;
+        float* gi = grad_in.data() + (size_t)b * 3 * H;
+        float* gh = grad_hid.data() + (size_t)b * 3 * H;
+        for (int j = 0; j < H; ++j) {
+            float dn = dh[j] * (1.0f - z_g[j]) * (1.0f - n_g[j] * n_g[j]);
+            float dz = dh[j] * (hp[j] - n_g[j]) * z_g[j] * (1.0f - z_g[j]);
+            float dr = dn * hn[j] * r_g[j] * (1.0f - r_g[j]);
+            gi[j] = dr;
+            gi[H + j] = dz;
+            gi[2 * H + j] = dn;
+            gh[j] = dr;
+            gh[H + j] = dz;
+            gh[2 * H + j] = dn * r_g[j];
+            dh[j] = dh[j] * z_g[j];
+        }
+    }
+
+    accumulate_rows(grad_in.data(), batch, 3 * H, grad_bias_x.data());
+    accumulate_rows(grad_hid.data(), batch, 3 * H, grad_bias_h.data());
+    gemm(true, false, I, 3 * H, batch, 1.0f, cache.x.data(), I, grad_in.data(), 3 * H,
+         1.0f, grad_weights_x.data(), 3 * H);
+    gemm(true, false, H, 3 * H, batch, 1.0f, cache.h_prev.data(), H, grad_hid.data(), 3 * H,
+         1.0f, grad_weights_h.data(), 3 * H);
+
+    grad_x.resize((size_t)batch * I);
+    gemm(false, true, batch, I, 3 * H, 1.0f, grad_in.data(), 3 * H, weights_x.data(), 3 * H,
+         0.0f, grad_x.data(), I);
+    gemm(false, true, batch, H, 3 * H, 1.0f, grad_hid.data(), 3 * H, weights_h.data(), 3 * H,
+         1.0f, grad_h.data(), H);
+}
+
+void GRUCell::zero_grad()
+{
+    std::fill(grad_weights_x.begin(), grad_weights_x.end(), 0.0f);
+    std::fill(grad_weights_h.begin(), grad_weights_h.end(), 0.0f);
+    std::fill(grad_bias_x.begin(), grad_bias_x.end(), 0.0f);
+    std::fill(grad_bias_h.begin(), grad_bias_h.end(), 0.0f);
+}
@@ -0,0 +1,238 @@
+//
+//  sequence.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Packing of variable-length sequences and the recurrent loops over packed batches.
+//  Because the sequences are sorted by decreasing length, the active rows of a time step are a
+//  prefix of the state buffers: when sequences finish, the states are simply shrunk, and in the
+//  backward pass they grow back with zero gradients for the rows that start there.
+//
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include "../headers/sequence.h"
+
+PackedSequence pack_sequences(const std::vector<std::vector<float>>& sequences, int feature_size)
+{
+    if (feature_size <= 0) {
+        throw std::invalid_argument("Feature size must be positive.");
+    }
+    PackedSequence packed;
+    packed.feature_size = feature_size;
+
+    std::vector<int> lengths(sequences.size());
+    for (size_t s = 0; s < sequences.size(); ++s) {
+        if (sequences[s].size() % feature_size != 0) {
+            throw std::invalid_argument("Sequence size is not a multiple of the feature size.");
+        }
+        lengths[s] = (int)(sequences[s].size() / feature_size);
+    }
+    packed.sorted_indices.resize(sequences.size());
+    std::iota(packed.sorted_indices.begin(), packed.sorted_indices.end(), 0);
+    std::stable_sort(packed.sorted_indices.begin(), packed.sorted_indices.end(),
+                     [&lengths](int a, int b) { return lengths[a] > lengths[b]; });
+    for (int s : packed.sorted_indices) {
+        packed.lengths.push_back(lengths[s]);
+    }
+
+    int max_length = packed.lengths.empty() ? 0 : packed.lengths.front();
+    size_t total = 0;
+    for (int t = 0; t < max_length; ++t) {
+        int active = 0;
+        while (active < (int)packed.lengths.size() && packed.lengths[active] > t) {
+            ++active;
+        }
+        packed.batch_sizes.push_back(active);
+        total += active;
+    }
+
+    packed.data.resize(total * feature_size);
+    float* out = packed.data.data();
+    for (int t = 0; t < max_length; ++t) {
+        for (int b = 0; b < packed.batch_sizes[t]; ++b) {
+            const float* src = sequences[packed.sorted_indices[b]].data() + (size_t)t * feature_size;
+            out = std::copy(src, src + feature_size, out);
+        }
+    }
+    return packed;
+}
+
+std::vector<std::vector<float>> unpack_sequences(const PackedSequence& packed)
+{
+    int f = packed.feature_size;
+    std::vector<std::vector<float>> sequences(packed.sorted_indices.size());
+    for (size_t b = 0; b < packed.sorted_indices.size(); ++b) {
+        sequences[packed.sorted_indices[b]].resize((size_t)packed.lengths[b] * f);
+    }
+    const float* src = packed.data.data();
+    for (size_t t = 0; t < packed.batch_sizes.size(); ++t) {
+        for (int b = 0; b < packed.batch_sizes[t]; ++b) {
+            std::copy(src, src + f, sequences[packed.sorted_indices[b]].begin() + t * f);
+            src += f;
+        }
+    }
+    return sequences;
+}
+
+std::vector<int> pack_labels(const std::vector<std::vector<int>>& labels, const PackedSequence& layout)
+{
+    if (labels.size() != layout.sorted_indices.size()) {
+        throw std::invalid_argument("Labels and layout must have the same batch size.");
+    }
+    for (size_t b = 0; b < layout.sorted_indices.size(); ++b) {
+        if ((int)labels[layout.sorted_indices[b]].size() != layout.lengths[b]) {
+            throw std::invalid_argument("Label sequence length does not match the layout.");
+        }
+    }
+    std::vector<int> packed;
+    packed.reserve(layout.total_tokens());
+    for (size_t t = 0; t < layout.batch_sizes.size(); ++t) {
+        for (int b = 0; b < layout.batch_sizes[t]; ++b) {
+            packed.push_back(labels[layout.sorted_indices[b]][t]);
+        }
+    }
+    return packed;
+}
+
+PackedSequence packed_like(const PackedSequence& layout, int feature_size)
+{
+    PackedSequence packed;
+    packed.feature_size = feature_size;
+    packed.batch_sizes = layout.batch_sizes;
+    packed.sorted_indices = layout.sorted_indices;
+    packed.lengths = layout.lengths;
+    packed.data.assign(layout.total_tokens() * feature_size, 0.0f);
+    return packed;
+}
+
+// Rows of time step t: [offset, offset + batch_sizes[t]) of the packed data
+static void copy_rows_out(const PackedSequence& packed, size_t offset, int rows, std::vector<float>& out)
+{
+    const float* src = packed.data.data() + offset * packed.feature_size;
+    out.assign(src, src + (size_t)rows * packed.feature_size);
+}
+
+static void copy_rows_in(const std::vector<float>& in, size_t offset, int rows, PackedSequence& packed)
+{
+    std::copy(in.begin(), in.begin() + (size_t)rows * packed.feature_size,
+              packed.data.begin() + offset * packed.feature_size);
+}
+
+static std::vector<size_t> step_offsets(const PackedSequence& packed)
+{
+    std::vector<size_t> offsets(packed.batch_sizes.size() + 1, 0);
+    for (size_t t = 0; t < packed.batch_sizes.size(); ++t) {
+        offsets[t + 1] = offsets[t] + packed.batch_sizes[t];
+    }
+    return offsets;
+}
+
+void lstm_forward_packed(const LSTMCell& cell, const PackedSequence& input, PackedSequence& output,
+                         std::vector<LSTMStepCache>* caches)
+{
+    if (input.feature_size != cell.input_size) {
+        throw std::invalid_argument("Packed input feature size does not match the cell input size.");
+    }
+    const int H = cell.hidden_size;
+    output = packed_like(input, H);
+    std::vector<size_t> offsets = step_offsets(input);
+    if (caches) {
+        caches->resize(input.batch_sizes.size());
+    }
+
+    int batch = input.batch_sizes.empty() ? 0 : input.batch_sizes.front();
+    std::vector<float> h((size_t)batch * H, 0.0f), c((size_t)batch * H, 0.0f);
+    std::vector<float> x, h_next, c_next;
+    for (size_t t = 0; t < input.batch_sizes.size(); ++t) {
+        int active = input.batch_sizes[t];
+        // Finished sequences leave the end of the sorted batch
+        h.resize((size_t)active * H);
+        c.resize((size_t)active * H);
+        copy_rows_out(input, offsets[t], active, x);
+        cell.forward(x, h, c, h_next, c_next, active, caches ? &(*caches)[t] : nullptr);
+        h.swap(h_next);
+        c.swap(c_next);
+        copy_rows_in(h, offsets[t], active, output);
+    }
+}
+
+void lstm_backward_packed(LSTMCell& cell, const std::vector<LSTMStepCache>& caches,
+                          const PackedSequence& grad_output, PackedSequence& grad_input)
+{
+    if (caches.size() != grad_output.batch_sizes.size()) {
+        throw std::invalid_argument("One cache per time step is needed.");
+    }
+    if (grad_output.feature_size != cell.hidden_size) {
+        throw std::invalid_argument("Packed gradient feature size does not match the cell hidden size.");
+    }
+    const int H = cell.hidden_size;
+    grad_input = packed_like(grad_output, cell.input_size);
+    std::vector<size_t> offsets = step_offsets(grad_output);
+
+    std::vector<float> grad_h, grad_c, grad_x;
+    for (size_t t = caches.size(); t-- > 0;) {
+        int active = grad_output.batch_sizes[t];
+        // Sequences whose last step is t join with zero state gradients
+        grad_h.resize((size_t)active * H, 0.0f);
+        grad_c.resize((size_t)active * H, 0.0f);
+        const float* g = grad_output.data.data() + offsets[t] * H;
+        for (size_t i = 0; i < (size_t)active * H; ++i) {
+            grad_h[i] += g[i];
+        }
+        cell.backward(caches[t], grad_h, grad_c, grad_x, active);
+        copy_rows_in(grad_x, offsets[t], active, grad_input);
+    }
+}
+
+void gru_forward_packed(const GRUCell& cell, const PackedSequence& input, PackedSequence& output,
+                        std::vector<GRUStepCache>* caches)
+{
+    if (input.feature_size != cell.input_size) {
+        throw std::invalid_argument("Packed input feature size does not match the cell input size.");
+    }
+    const int H = cell.hidden_size;
+    output = packed_like(input, H);
+    std::vector<size_t> offsets = step_offsets(input);
+    if (caches) {
+        caches->resize(input.batch_sizes.size());
+    }
+
+    int batch = input.batch_sizes.empty() ? 0 : input.batch_sizes.front();
+    std::vector<float> h((size_t)batch * H, 0.0f);
+    std::vector<float> x, h_next;
+    for (size_t t = 0; t < input.batch_sizes.size(); ++t) {
+        int active = input.batch_sizes[t];
+        h.resize((size_t)active * H);
+        copy_rows_out(input, offsets[t], active, x);
+        cell.forward(x, h, h_next, active, caches ? &(*caches)[t] : nullptr);
+        h.swap(h_next);
+        copy_rows_in(h, offsets[t], active, output);
+    }
+}
+
+void gru_backward_packed(GRUCell& cell, const std::vector<GRUStepCache>& caches,
+                         const PackedSequence& grad_output, PackedSequence& grad_input)
+{
+    if (caches.size() != grad_output.batch_sizes.size()) {
+        throw std::invalid_argument("One cache per time step is needed.");
+    }
+    if (grad_output.feature_size != cell.hidden_size) {
+        throw std::invalid_argument("Packed gradient feature size does not match the cell hidden size.");
+    }
+    const int H = cell.hidden_size;
+    grad_input = packed_like(grad_output, cell.input_size);
+    std::vector<size_t> offsets = step_offsets(grad_output);
+
+    std::vector<float> grad_h, grad_x;
+    for (size_t t = caches.size(); t-- > 0;) {
+        int active = grad_output.batch_sizes[t];
+        grad_h.resize((size_t)active * H, 0.0f);
+        const float* g = grad_output.data.data() + offsets[t] * H;
+        for (size_t i = 0; i < (size_t)active * H; ++i) {
+            grad_h[i] += g[i];
+        }
+        cell.backward(caches[t], grad_h, grad_x, active);
+        copy_rows_in(grad_x, offsets[t], active, grad_input);
+    }
+}
@@ -0,0 +1,464 @@
+//
+//  thread_pool.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Work-stealing thread pool.
+//  A parallel_for is cut into chunks of grain elements. The chunk range is first split evenly
+//  between the deques of the workers and of the calling thread. A thread runs a range by
+//  repeatedly pushing its upper half back on its own deque and keeping the lower half, until a
+//  single chunk is left, which it runs. When its deque is empty it steals the oldest (largest)
+//  range of another deque. The deques are Chase-Lev deques: the owner pushes and pops at the
+//  bottom without locks, thieves take from the top with one compare-and-swap.
+//  Only one parallel_for runs on the pool at a time; concurrent callers wait their turn, and a
+//  parallel_for called from inside a chunk runs serially.
+//  Pinned workers steal from the threads of their own NUMA node before the others.
+//  In latency mode idle workers poll the job epoch for a while before going to sleep, and the
+//  caller polls for the workers to leave the job instead of sleeping on the condition variable,
+//  so a parallel_for on a warm pool does not go through the kernel at all.
+//
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <condition_variable>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include "../headers/thread_pool.h"
+#include "../headers/numa.h"
+
+// A task is a range of chunk indices [first, last) packed in 64 bits
+typedef uint64_t Task;
+
+static Task make_task(uint64_t first, uint64_t last) { return (first << 32) | last; }
+static uint64_t task_first(Task t) { return t >> 32; }
+static uint64_t task_last(Task t) { return t & 0xFFFFFFFFu; }
+
+// Chase-Lev work-stealing deque with a fixed capacity
+class WorkDeque {
+public:
+    static const int64_t CAPACITY = 1024;
+
+    bool push(Task task)
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY) {
+            return false;
+        }
+        slots_[b % CAPACITY].store(task, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool pop(Task& task)
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        task = slots_[b % CAPACITY].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last task, race with the thieves for it
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    bool steal(Task& task)
+    {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        task = slots_[t % CAPACITY].load(std::memory_order_relaxed);
+        return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<Task> slots_[CAPACITY];
+};
+
+// One parallel_for in flight
+struct Job {
+    const ChunkBody* body;
+    size_t begin;
+    size_t end;
+    size_t grain;
+    std::atomic<size_t> remaining;
+    std::atomic<bool> cancelled{false};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+};
+
+static thread_local bool in_parallel_region = false;
+
+// Busy-wait hint, lets the sibling hyperthread run while we poll
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+class ThreadPool {
+public:
+    explicit ThreadPool(const ThreadPoolConfig& config);
+    ~ThreadPool();
+
+    int num_threads() const { return (int)workers_.size() + 1; }
+    bool workers_awake() const { return awake_.load(std::memory_order_relaxed) > 0; }
+    int thread_cpu(int index) const { return cpus_[index]; }
+    void run(size_t begin, size_t end, size_t grain, const ChunkBody& body);
+
+private:
+    void worker_main(int index);
+    void spin_for_job(uint64_t seen);
+    void wait_workers_idle();
+    void work(int index, Job& job);
+    void execute(int index, Job& job, Task task);
+    bool find_task(int index, Task& task);
+
+    std::vector<std::thread> workers_;
+    // One deque per worker plus one for the calling thread (the last one)
+    std::unique_ptr<WorkDeque[]> deques_;
+    // Per thread: pinned CPU or -1, and the deques to steal from, nearest first
+    std::vector<int> cpus_;
+    std::vector<std::vector<int>> victims_;
+
+    std::mutex submit_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    Job* job_ = nullptr;
+    // Written under mutex_, atomic so that spinning threads can poll them without it
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<int> active_{0};
+    std::atomic<bool> stopping_{false};
+    // Workers not sleeping on wake_
+    std::atomic<int> awake_{0};
+    std::chrono::nanoseconds spin_;
+};
+
+WaitPolicy ThreadPoolConfig::default_wait_policy()
+{
+    const char* env = std::getenv("DLLIB_WAIT_POLICY");
+    return env && std::strcmp(env, "latency") == 0 ? WaitPolicy::Latency : WaitPolicy::Passive;
+}
+
+static int default_num_threads()
+{
+    if (const char* env = std::getenv("DLLIB_NUM_THREADS")) {
+        int n = std::atoi(env);
+        if (n > 0) return n;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+static void pin_current_thread(int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+ThreadPool::ThreadPool(const ThreadPoolConfig& config)
+{
+    int threads = config.num_threads > 0 ? config.num_threads : default_num_threads();
+    spin_ = config.wait_policy == WaitPolicy::Latency ? std::chrono::microseconds(std::max(0, config.spin_microseconds))
+                                                      : std::chrono::nanoseconds(0);
+    awake_.store(threads - 1);
+    deques_.reset(new WorkDeque[threads]);
+    std::vector<int> cpus = config.cpus;
+    for (int node = 0; cpus.empty() && node < numa_node_count(); ++node) {
+        const std::vector<int>& node_cpus = numa_node_cpus(node);
+        cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+    }
+    cpus_.assign(threads, -1);
+    for (int i = 0; config.pin_threads && !cpus.empty() && i + 1 < threads; ++i) {
+        cpus_[i] = cpus[i % cpus.size()];
+    }
+
+    // Same node first, each group in ring order from the thread itself
+    victims_.resize(threads);
+    for (int i = 0; i < threads; ++i) {
+        int node = cpus_[i] < 0 ? -1 : numa_node_of_cpu(cpus_[i]);
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int k = 1; k < threads; ++k) {
+                int j = (i + k) % threads;
+                bool same = node >= 0 && cpus_[j] >= 0 && numa_node_of_cpu(cpus_[j]) == node;
+                if (same == (pass == 0)) {
+                    victims_[i].push_back(j);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i + 1 < threads; ++i) {
+        int cpu = cpus_[i];
+        workers_.emplace_back([this, i, cpu] {
+            if (cpu >= 0) pin_current_thread(cpu);
+            worker_main(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+// Poll for a new job until the spin time runs out, checking the clock every few iterations
+void ThreadPool::spin_for_job(uint64_t seen)
+{
+    auto deadline = std::chrono::steady_clock::now() + spin_;
+    for (int i = 1; epoch_.load(std::memory_order_acquire) == seen && !stopping_.load(std::memory_order_relaxed); ++i) {
+        cpu_relax();
+        if (i % 64 == 0 && std::chrono::steady_clock::now() >= deadline) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::worker_main(int index)
+{
+    uint64_t seen = 0;
+    while (true) {
+        if (spin_.count() > 0) {
+            spin_for_job(seen);
+        }
+        Job* job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto ready = [&] { return stopping_ || (epoch_ != seen && job_); };
+            if (!ready()) {
+                awake_.fetch_sub(1, std::memory_order_relaxed);
+                wake_.wait(lock, ready);
+                awake_.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (stopping_) return;
+            seen = epoch_;
+            job = job_;
+            ++active_;
+        }
+        in_parallel_region = true;
+        work(index, *job);
+        in_parallel_region = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_;
+        }
+        wake_.notify_all();
+    }
+}
+
+// Own deque first, then the other deques, nearest first
+bool ThreadPool::find_task(int index, Task& task)
+{
+    if (deques_[index].pop(task)) {
+        return true;
+    }
+    for (int victim : victims_[index]) {
+        if (deques_[victim].steal(task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::execute(int index, Job& job, Task task)
+{
+    uint64_t first = task_first(task), last = task_last(task);
+    // Keep the lower half, offer the upper half to the thieves
+    while (last - first > 1) {
+        uint64_t mid = first + (last - first) / 2;
+        if (!deques_[index].push(make_task(mid, last))) {
+            break;
+        }
+        last = mid;
+    }
+    for (uint64_t chunk = first; chunk < last; ++chunk) {
+        if (!job.cancelled.load(std::memory_order_relaxed)) {
+            size_t chunk_begin = job.begin + chunk * job.grain;
+            size_t chunk_end = std::min(job.end, chunk_begin + job.grain);
+            try {
+                (*job.body)(chunk_begin, chunk_end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.error_mutex);
+                if (!job.error) job.error = std::current_exception();
+                job.cancelled.store(true, std::memory_order_relaxed);
+            }
+        }
+        job.remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void ThreadPool::work(int index, Job& job)
+{
+    Task task;
+    while (job.remaining.load(std::memory_order_acquire) > 0) {
+        if (find_task(index, task)) {
+            execute(index, job, task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ThreadPool::run(size_t begin, size_t end, size_t grain, const ChunkBody& body)
+{
+    std::lock_guard<std::mutex> submit(submit_mutex_);
+    size_t chunks = (end - begin + grain - 1) / grain;
+    if (chunks > 0xFFFFFFFFu) {
+        grain = (end - begin + 0xFFFFFFFEu) / 0xFFFFFFFFu;
+        chunks = (end - begin + grain - 1) / grain;
+    }
+
+    Job job;
+    job.body = &body;
+    job.begin = begin;
+    job.end = end;
+    job.grain = grain;
+    job.remaining.store(chunks);
+
+    // Even initial split, the deques are empty and nobody runs yet
+    int n = num_threads();
+    for (int i = 0; i < n; ++i) {
+        uint64_t first = chunks * i / n, last = chunks * (i + 1) / n;
+        if (first < last) {
+            deques_[i].push(make_task(first, last));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        ++epoch_;
+    }
+    wake_.notify_all();
+
+    in_parallel_region = true;
+    work(n - 1, job);
+    in_parallel_region = false;
+
+    wait_workers_idle();
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+// Wait until no worker can still look at the job
+void ThreadPool::wait_workers_idle()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = nullptr;
+    }
+    if (spin_.count() > 0) {
+        // The workers leave the job right after the last chunk, no point sleeping for that
+        auto deadline = std::chrono::steady_clock::now() + spin_;
+        for (int i = 1; active_.load(std::memory_order_acquire) != 0; ++i) {
+            cpu_relax();
+            if (i % 64 == 0 && std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    wake_.wait(lock, [&] { return active_ == 0; });
+}
+
+// parallel_for holds a reference to the pool for its whole run, so configure_thread_pool called
+// from another thread only swaps the pointer: the old pool is destroyed (its workers joined) when
+// the last run still using it returns.
+static std::mutex pool_mutex;
+static std::shared_ptr<ThreadPool> pool;
+
+static std::shared_ptr<ThreadPool> thread_pool()
+{
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (!pool) {
+        pool = std::make_shared<ThreadPool>(ThreadPoolConfig());
+    }
+    return pool;
+}
+
+void configure_thread_pool(const ThreadPoolConfig& config)
+{
+    if (in_parallel_region) {
+        throw std::logic_error("The thread pool can not be reconfigured from inside a parallel_for.");
+    }
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    pool.reset();
+    pool = std::make_shared<ThreadPool>(config);
+}
+
+int num_threads()
+{
+    return thread_pool()->num_threads();
+}
+
+int pool_thread_cpu(int thread)
+{
+    std::shared_ptr<ThreadPool> p = thread_pool();
+    if (thread < 0 || thread >= p->num_threads()) {
+        throw std::out_of_range("Thread index is out of range for the pool.");
+    }
+    return p->thread_cpu(thread);
+}
+
+void parallel_for(size_t begin, size_t end, size_t grain, ChunkBody body)
+{
+    if (end <= begin) {
+        return;
+    }
+    grain = grain ? grain : 1;
+    size_t chunks = (end - begin + grain - 1) / grain;
+    // Single chunks and nested calls do not look at the pool at all, so that small kernels
+    // called in a loop (e.g. on the tiles of a fused graph node) do not take its lock
+    std::shared_ptr<ThreadPool> p = chunks == 1 || in_parallel_region ? nullptr : thread_pool();
+    if (!p || p->num_threads() == 1 || (chunks < MIN_CHUNKS_TO_WAKE && !p->workers_awake())) {
+        // Same chunks as the parallel path, so callers indexing partial results by chunk still work
+        for (size_t chunk_begin = begin; chunk_begin < end; chunk_begin += grain) {
+            body(chunk_begin, std::min(end, chunk_begin + grain));
+        }
+        return;
+    }
+    p->run(begin, end, grain, body);
+}
@@ -0,0 +1,368 @@
+//
+//  weight_file.cpp
+//  DeepLearningLibrary
+//
+//  Created by IK on 17/10/2026.
+//  Weight file layout, all integers in the byte order of the writer:
+//    FileHeader                      64 bytes
+//    DirectoryEntry x tensor_count   128 bytes each
+//    payloads                        each at an offset that is a multiple of WEIGHT_ALIGNMENT,
+//                                    zero padding in between
+//  The file is mapped whole; it is written the same way, into a mapping of a file of the final
+//  size, so both sides share the layout code below.
+//
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../headers/weight_file.h"
+
+static const char MAGIC[8] = {'D', 'L', 'L', 'W', 'G', 'H', 'T', '\0'};
+static const uint32_t VERSION = 1;
+// Reads back as 0x04030201 on a machine of the other byte order
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t tensor_count;
+    uint64_t directory_offset;
+    uint64_t file_bytes;
+    uint64_t reserved[3];
+};
+
+struct DirectoryEntry {
+    char name[WEIGHT_MAX_NAME + 1];
+    uint32_t type;
+    uint32_t rank;
+    uint64_t shape[WEIGHT_MAX_RANK];
+    uint64_t offset;
+    uint64_t bytes;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 64, "The weight file header is 64 bytes.");
+static_assert(sizeof(DirectoryEntry) == 128, "Weight file directory entries are 128 bytes.");
+
+static size_t align_up(size_t bytes)
+{
+    return (bytes + WEIGHT_ALIGNMENT - 1) / WEIGHT_ALIGNMENT * WEIGHT_ALIGNMENT;
+}
+
+size_t tensor_type_size(TensorType type)
+{
+    switch (type) {
+        case TensorType::Float32: return sizeof(float);
+        case TensorType::Int8: return sizeof(int8_t);
+        case TensorType::Int32: return sizeof(int32_t);
+    }
+    throw std::invalid_argument("Unknown tensor type.");
+}
+
+size_t WeightTensor::elements() const
+{
+    size_t n = 1;
+    for (size_t d : shape) {
+        n *= d;
+    }
+    return n;
+}
+
+// Writer
+
+void WeightFileWriter::add(const std::string& name, const float* data, const std::vector<size_t>& shape)
+{
+    add(name, TensorType::Float32, data, shape);
+}
+
+void WeightFileWriter::add(const std::string& name, const int8_t* data, const std::vector<size_t>& shape)
+{
+    add(name, TensorType::Int8, data, shape);
+}
+
+void WeightFileWriter::add(const std::string& name, const int32_t* data, const std::vector<size_t>& shape)
+{
+    add(name, TensorType::Int32, data, shape);
+}
+
+void WeightFileWriter::add(const std::string& name, TensorType type, const void* data, const std::vector<size_t>& shape)
+{
+    if (name.empty() || name.size() > WEIGHT_MAX_NAME || name.find('\0') != std::string::npos) {
+        throw std::invalid_argument("Tensor names must have 1 to 63 characters.");
+    }
+    if (shape.empty() || shape.size() > WEIGHT_MAX_RANK) {
+        throw std::invalid_argument("Tensor shapes must have 1 to 4 dimensions.");
+    }
+    for (size_t d : shape) {
+        if (d == 0) {
+            throw std::invalid_argument("Tensor dimensions must be positive.");
+        }
+    }
+    if (!data) {
+        throw std::invalid_argument("Tensor data must not be null.");
+    }
+    for (const Pending& tensor : tensors_) {
+        if (tensor.name == name) {
+            throw std::invalid_argument("Tensor " + name + " was already added.");
+        }
+    }
+    tensors_.push_back({name, type, shape, data});
+}
+
+void WeightFileWriter::write(const std::string& path) const
+{
+    FileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.tensor_count = tensors_.size();
+    header.directory_offset = sizeof(FileHeader);
+
+    std::vector<DirectoryEntry> directory(tensors_.size());
+    size_t end = align_up(sizeof(FileHeader) + directory.size() * sizeof(DirectoryEntry));
+    for (size_t t = 0; t < tensors_.size(); ++t) {
+        const Pending& tensor = tensors_[t];
+        DirectoryEntry& entry = directory[t];
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.name, tensor.name.data(), tensor.name.size());
+        entry.type = (uint32_t)tensor.type;
+        entry.rank = (uint32_t)tensor.shape.size();
+        size_t elements = 1;
+        for (size_t d = 0; d < tensor.shape.size(); ++d) {
+            entry.shape[d] = tensor.shape[d];
+            elements *= tensor.shape[d];
+        }
+        entry.offset = end;
+        entry.bytes = elements * tensor_type_size(tensor.type);
+        end = align_up(end + entry.bytes);
+    }
+    header.file_bytes = end;
+
+    // One temporary per process, two processes writing the same file do not mix their bytes
+    std::string temporary = path + ".tmp." + std::to_string(getpid());
+    int fd = open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create the weight file " + temporary);
+    }
+    // Reserve the blocks up front: a sparse file (ftruncate) would only run out of space while
+    // the payload is copied into the mapping, which is a SIGBUS rather than an error
+    int rc = posix_fallocate(fd, 0, (off_t)end);
+    if (rc != 0) {
+        close(fd);
+        unlink(temporary.c_str());
+        throw std::runtime_error("Failed to allocate " + std::to_string(end) + " bytes for the weight file " +
+                                 temporary + ": " + std::strerror(rc));
+    }
+    void* addr = mmap(nullptr, end, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        unlink(temporary.c_str());
+        throw std::runtime_error("Failed to mmap the weight file " + temporary);
+    }
+    char* base = static_cast<char*>(addr);
+    std::memcpy(base, &header, sizeof(header));
+    if (!directory.empty()) {
+        std::memcpy(base + header.directory_offset, directory.data(), directory.size() * sizeof(DirectoryEntry));
+    }
+    for (size_t t = 0; t < tensors_.size(); ++t) {
+        std::memcpy(base + directory[t].offset, tensors_[t].data, directory[t].bytes);
+    }
+    bool synced = msync(addr, end, MS_SYNC) == 0;
+    munmap(addr, end);
+    if (!synced || rename(temporary.c_str(), path.c_str()) != 0) {
+        unlink(temporary.c_str());
+        throw std::runtime_error("Failed to write the weight file " + path);
+    }
+}
+
+// Reader
+
+static void invalid(const std::string& path, const char* reason)
+{
+    throw std::invalid_argument(path + " is not a valid weight file: " + reason);
+}
+
+WeightFile::WeightFile(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open the weight file " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to stat the weight file " + path);
+    }
+    bytes_ = (size_t)st.st_size;
+    modified_ns_ = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    if (bytes_ < sizeof(FileHeader)) {
+        close(fd);
+        invalid(path, "too short");
+    }
+    // Read-only and shared: the pages come from the page cache and are never copied
+    void* addr = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Failed to mmap the weight file " + path);
+    }
+    mapping_ = addr;
+
+    try {
+        const char* base = static_cast<const char*>(mapping_);
+        FileHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) invalid(path, "bad magic");
+        if (header.byte_order != BYTE_ORDER_MARK) invalid(path, "written with the other byte order");
+        if (header.version != VERSION) invalid(path, "unsupported version");
+        if (header.file_bytes != bytes_) invalid(path, "truncated");
+        if (header.directory_offset < sizeof(FileHeader) || header.directory_offset > bytes_ ||
+            header.tensor_count > (bytes_ - header.directory_offset) / sizeof(DirectoryEntry)) {
+            invalid(path, "directory out of the file");
+        }
+
+        size_t directory_end = header.directory_offset + header.tensor_count * sizeof(DirectoryEntry);
+        tensors_.reserve(header.tensor_count);
+        for (size_t t = 0; t < header.tensor_count; ++t) {
+            DirectoryEntry entry;
+            std::memcpy(&entry, base + header.directory_offset + t * sizeof(DirectoryEntry), sizeof(entry));
+            if (std::memchr(entry.name, '\0', sizeof(entry.name)) == nullptr || entry.name[0] == '\0') {
+                invalid(path, "bad tensor name");
+            }
+            if (entry.type > (uint32_t)TensorType::Int32) invalid(path, "unknown tensor type");
+            if (entry.rank == 0 || entry.rank > WEIGHT_MAX_RANK) invalid(path, "bad tensor rank");
+
+            WeightTensor tensor;
+            tensor.name = entry.name;
+            tensor.type = (TensorType)entry.type;
+            // Each dimension is at most the file size, so the product can be checked step by step
+            size_t elements = 1;
+            for (uint32_t d = 0; d < entry.rank; ++d) {
+                if (entry.shape[d] == 0 || entry.shape[d] > bytes_ || elements > bytes_ / entry.shape[d]) {
+                    invalid(path, "bad tensor shape");
+                }
+                elements *= entry.shape[d];
+                tensor.shape.push_back(entry.shape[d]);
+            }
+            if (entry.bytes != elements * tensor_type_size(tensor.type)) invalid(path, "tensor size does not match its shape");
+            if (entry.offset % WEIGHT_ALIGNMENT != 0 || entry.offset < directory_end ||
+                entry.bytes > bytes_ || entry.offset > bytes_ - entry.bytes) {
+                invalid(path, "tensor out of the file");
+            }
+            tensor.data = base + entry.offset;
+            tensor.bytes = entry.bytes;
+            if (!index_.emplace(tensor.name, tensors_.size()).second) invalid(path, "duplicate tensor name");
+            tensors_.push_back(std::move(tensor));
+        }
+    } catch (...) {
+        munmap(mapping_, bytes_);
+        throw;
+    }
+}
+
+WeightFile::WeightFile(WeightFile&& other) noexcept
+    : mapping_(other.mapping_), bytes_(other.bytes_), modified_ns_(other.modified_ns_),
+      tensors_(std::move(other.tensors_)), index_(std::move(other.index_))
+{
+    other.mapping_ = nullptr;
+    other.bytes_ = 0;
+}
+
+WeightFile& WeightFile::operator=(WeightFile&& other) noexcept
+{
+    if (this != &other) {
+        if (mapping_) {
+            munmap(mapping_, bytes_);
+        }
+        mapping_ = other.mapping_;
+        bytes_ = other.bytes_;
+        modified_ns_ = other.modified_ns_;
+        tensors_ = std::move(other.tensors_);
+        index_ = std::move(other.index_);
+        other.mapping_ = nullptr;
+        other.bytes_ = 0;
+    }
+    return *this;
+}
+
+WeightFile::~WeightFile()
+{
+    if (mapping_) {
+        munmap(mapping_, bytes_);
+    }
+}
+
+const WeightTensor& WeightFile::tensor(const std::string& name) const
+{
+    auto found = index_.find(name);
+    if (found == index_.end()) {
+        throw std::out_of_range("The weight file has no tensor " + name);
+    }
+    return tensors_[found->second];
+}
+
+const void* WeightFile::checked(const std::string& name, TensorType type, const std::vector<size_t>& shape) const
+{
+    const WeightTensor& t = tensor(name);
+    if (t.type != type) {
+        throw std::invalid_argument("Tensor " + name + " has a different type.");
+    }
+    if (t.shape != shape) {
+        throw std::invalid_argument("Tensor " + name + " has a different shape.");
+    }
+    return t.data;
+}
+
+const float* WeightFile::floats(const std::string& name, const std::vector<size_t>& shape) const
+{
+    return static_cast<const float*>(checked(name, TensorType::Float32, shape));
+}
+
+const int8_t* WeightFile::int8s(const std::string& name, const std::vector<size_t>& shape) const
+{
+    return static_cast<const int8_t*>(checked(name, TensorType::Int8, shape));
+}
+
+const int32_t* WeightFile::int32s(const std::string& name, const std::vector<size_t>& shape) const
+{
+    return static_cast<const int32_t*>(checked(name, TensorType::Int32, shape));
+}
+
+void WeightFile::prefetch() const
+{
+    if (mapping_) {
+        madvise(mapping_, bytes_, MADV_WILLNEED);
+    }
+}
+
+// MLP layers
+
+static std::string layer_name(size_t i, const char* part)
+{
+    return "layer" + std::to_string(i) + "." + part;
+}
+
+void save_weights(const std::vector<Dense>& layers, const std::string& path)
+{
+    WeightFileWriter writer;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        const Dense& layer = layers[i];
+        writer.add(layer_name(i, "weight"), layer.weights.data(), {(size_t)layer.in_features, (size_t)layer.out_features});
+        writer.add(layer_name(i, "bias"), layer.bias.data(), {(size_t)layer.out_features});
+    }
+    writer.write(path);
+}
+
+void load_weights(std::vector<Dense>& layers, const WeightFile& file)
+{
+    for (size_t i = 0; i < layers.size(); ++i) {
+        Dense& layer = layers[i];
+        const float* weights = file.floats(layer_name(i, "weight"), {(size_t)layer.in_features, (size_t)layer.out_features});
+        const float* bias = file.floats(layer_name(i, "bias"), {(size_t)layer.out_features});
+        std::copy(weights, weights + layer.weights.size(), layer.weights.begin());
+        std::copy(bias, bias + layer.bias.size(), layer.bias.begin());
+    }
+}